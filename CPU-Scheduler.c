@@ -1,28 +1,55 @@
+#define _GNU_SOURCE
+
 #include <math.h>
-#include <signal.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "CPU-Scheduler.h"
+#include "Executor.h"
+#include "Group-Queue.h"
+#include "Timing-Wheel.h"
+#include "Workload-Pipeline.h"
+
 /*
  * Not an actual log level implementation, but a flag toggled between 0 and positive integers for more verbose executions
  */
 #define LOG_LEVEL 0
 
-#define TICK_TIME 1e5
-
-#define MAX_NAME 51
-#define MAX_DESC 101
-#define MAX_PROC 1000
 #define MAX_LINE 257
 
+/*
+ * Every process may wait in the timing wheel for its arrival, plus the running process' dispatch timer, so
+ * inserting into the wheel cannot fail
+ */
+#if MAX_PROC + 1 > WHEEL_CAPACITY
+#error "The timing wheel cannot hold MAX_PROC arrivals"
+#endif
+
+#define TIMER_ARRIVAL 0
+#define TIMER_DISPATCH_END 1
+
+#define CHECKPOINT_MAGIC "SCHK"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_DEFAULT_INTERVAL 100
+
+#define CACHE_DEFAULT_COLD_TIME 10
+
 #define CSV_DELIMS ","
+#define CSV_GROUP_WEIGHT_DELIM ':'
+#define CSV_TRIMMED " \t\r\n"
 
 #define PROC_LOG "%d → %d: %s Running %s.\n"
 #define IDLE_LOG "%d → %d: Idle.\n"
+#define SWITCH_LOG "%d → %d: Switching to %s.\n"
 #define ALGORITHM_FCFS "FCFS"
 #define ALGORITHM_SJF "SJF"
 #define ALGORITHM_PRIORITY "Priority"
@@ -36,46 +63,170 @@
 "\n──────────────────────────────────────────────\n" \
 ">> Engine Status  : Completed\n" \
 ">> Summary        :\n" \
-"   └─ Average Waiting Time : %.2f time units\n" \
-">> End of Report\n" \
-"══════════════════════════════════════════════\n\n"
+"   └─ Average Waiting Time : %.2f time units\n"
 
 #define SCHEDULER_OUTRO_TURNAROUND \
 "\n──────────────────────────────────────────────\n" \
 ">> Engine Status  : Completed\n" \
 ">> Summary        :\n" \
-"   └─ Total Turnaround Time : %d time units\n\n" \
+"   └─ Total Turnaround Time : %d time units\n\n"
+
+/*
+ * The summaries used once a cost model is set, the overhead's share being of the whole schedule
+ */
+#define SCHEDULER_OUTRO_TOTAL_WAIT_OVERHEAD \
+"\n──────────────────────────────────────────────\n" \
+">> Engine Status  : Completed\n" \
+">> Summary        :\n" \
+"   ├─ Average Waiting Time : %.2f time units\n" \
+"   └─ Dispatch Overhead    : %d time units (%.2f%%)\n"
+
+#define SCHEDULER_OUTRO_TURNAROUND_OVERHEAD \
+"\n──────────────────────────────────────────────\n" \
+">> Engine Status  : Completed\n" \
+">> Summary        :\n" \
+"   ├─ Total Turnaround Time : %d time units\n" \
+"   └─ Dispatch Overhead     : %d time units (%.2f%%)\n\n"
+
+/*
+ * Closes every summary, after the groups of a workload which has them
+ */
+#define SCHEDULER_OUTRO_GROUPS ">> Groups         :\n"
+#define SCHEDULER_OUTRO_GROUP "   %s %-16s : weight %d, %d processes, average waiting %.2f, turnaround %d\n"
+#define SCHEDULER_OUTRO_UNGROUPED "(ungrouped)"
+#define SCHEDULER_OUTRO_END \
 ">> End of Report\n" \
 "══════════════════════════════════════════════\n\n"
 
+#define STATS_INTRO \
+"══════════════════════════════════════════════\n" \
+">> Scheduler Statistics\n" \
+"──────────────────────────────────────────────\n"
+#define STATS_PHASE "   %-16s : %12.6f s\n"
+#define STATS_COUNTERS \
+"   %-16s : enqueues %ld, dequeues %ld, comparisons %ld, moves %ld,\n" \
+"   %-16s   context switches %ld, idle intervals %ld, iterations %ld\n"
+#define STATS_JITTER_INTRO "\n   Wakeup jitter (%ld wakeups, max %.3f ms):\n"
+#define STATS_JITTER_BUCKET "   %10s < %-8ld us : %ld\n"
+#define STATS_JITTER_OVERFLOW "   %10s >= %-7ld us : %ld\n"
+#define STATS_OUTRO "══════════════════════════════════════════════\n"
+
+#define MAX_POLICIES SCHEDULER_POLICIES_COUNT
 
-typedef struct
-{
-    char name[MAX_NAME];
-    char desc[MAX_DESC];
-    int arrival_time;
-    int burst_time;
-    int priority;
-    int original_idx;
-} Process;
 
+/*
+ * Kept sorted by CmpPriority, or in 'groups' when the workload has process groups, 'procs' being unused then
+ */
 typedef struct
 {
     Process procs[MAX_PROC];
     int size;
     int (*CmpPriority)(Process, Process);
+    SchedulerCounters* counters;
+    GroupQueue* groups;
 } ReadyQueue;
 
 
+/*
+ * Future events of a run: process arrivals (payload is the process' index) and the end of the running process'
+ * burst or time quantum. 'pendingArrivals' counts the arrivals still waiting in the wheel, and 'error' keeps the
+ * first failure of the expiry callback, which cannot return it. With a pipeline, arrivals only enter the wheel
+ * as the pipeline releases them.
+ */
+typedef struct
+{
+    TimerWheel wheel;
+    const Process* procs;
+    ReadyQueue* queue;
+    Executor* executor;
+    WorkloadPipeline* pipeline;
+    SchedulerError error;
+    int pendingArrivals;
+    bool hasArrived[MAX_PROC];
+} SchedulerTimers;
+
+/*
+ * The main loop's state between two events. While the dispatch overhead of the running process is being paid,
+ * processStartingTime is still ahead of schedulerUptime. lastRunEnd is when each process last left the CPU,
+ * -1 if it never ran, and lastProcessIdx the process which used the CPU last.
+ */
+typedef struct
+{
+    int schedulerUptime;
+    int iteration;
+    bool isProcessRunning;
+    Process runningProcess;
+    int processStartingTime;
+    bool isIdling;
+    int idleTimeStart;
+    int totalWaitingTime;
+    int turnaroundTime;
+    int overheadTime;
+    int lastProcessIdx;
+    int lastRunEnd[MAX_PROC];
+} SchedulerState;
+
+/*
+ * A process as it is stored in a checkpoint. Everything else about it is taken from the workload, only
+ * the fields which round robin modifies are kept.
+ */
+typedef struct
+{
+    int originalIdx;
+    int arrivalTime;
+    int burstTime;
+} ProcessCheckpoint;
+
+/*
+ * A snapshot of one policy's run, taken right before the event at state.schedulerUptime is handled.
+ * 'procsCount' is the number of processes in the workload the snapshot was taken on.
+ */
+typedef struct
+{
+    int procsCount;
+    SchedulerState state;
+    int runningIdx;
+    int queueSize;
+    ProcessCheckpoint queue[MAX_PROC];
+    bool isArrivalPending[MAX_PROC];
+} SchedulerCheckpoint;
+
+/*
+ * Checkpoints written during the run, and for each policy the snapshot a what-if run resumes from
+ */
+typedef struct
+{
+    FILE* file;
+    int interval;
+    bool hasResumePoint[MAX_POLICIES];
+    SchedulerCheckpoint resumePoints[MAX_POLICIES];
+} SchedulerCheckpoints;
+
 typedef struct
 {
+    SchedulerPolicy policy;
     int (*CmpPriority)(Process, Process);
     bool shouldPrintTurnaround;
     bool shouldPrintTotalWait;
-    char* name;
+    const char* name;
     int maxUptime;
 } AlgorithmData;
 
+/*
+ * Everything --stats reports. Phase timings are wall clock seconds and every policy's metrics carry its own
+ * counters, run time and wakeup jitter. 'output' is where the schedule itself is printed.
+ */
+typedef struct
+{
+    FILE* output;
+    bool isEnabled;
+    double csvLoadTime;
+    double outputTime;
+    int policiesCount;
+    const char* policyNames[MAX_POLICIES];
+    SchedulerMetrics policyMetrics[MAX_POLICIES];
+} SchedulerStats;
+
 
 int CmpPriorityNull(Process _, Process __);
 int CmpLowerPriority(Process a, Process b);
@@ -84,101 +235,297 @@ int ProcCmpPriority(Process a, Process b, int (*getProcessPriority)(Process));
 void Enqueue(ReadyQueue* queue, Process item);
 Process Dequeue(ReadyQueue* queue);
 bool IsEmpty(ReadyQueue queue);
-void InitProcessesFromCSV(const char* path, Process oprocs[], int* oprocsCount);
-Process ParseProcess(const char* line);
-void SortProcesses(Process procs[], int procCount, int (*predicate)(Process, Process));
-int ProcCmpArrivalTime(Process a, Process b);
+void SortProcesses(Process procs[], int procCount, int (*predicate)(Process, Process), SchedulerCounters* counters);
+struct timespec GetCurrentTime();
 double GetTimeElapsed(struct timespec startingTime);
-void EnqueueNewArrivals(ReadyQueue* queue, Process procs[], int* startingIdx, int procCount, int uptime);
-void SigAlarmHandler();
-void RunAlgorithm(AlgorithmData algorithm, Process procs[], int procsCount);
+AlgorithmData GetAlgorithmData(SchedulerPolicy policy, int timeQuantum);
+int GetRunLength(AlgorithmData algorithm, Process process);
+bool IsCostModelEnabled(SchedulerCostModel costModel);
+int GetDispatchOverhead(SchedulerCostModel costModel, const SchedulerState* state, int processIdx);
+void OnTimerExpiry(TimerWheelEntry entry, void* context);
+SchedulerError EnqueueNewArrivals(SchedulerTimers* timers, int uptime);
+bool IsTimeSettled(const SchedulerTimers* timers, int time);
+SchedulerError ReleaseArrival(SchedulerTimers* timers);
+SchedulerError WaitUntil(struct timespec startingTime, int uptime, SchedulerOptions options, SchedulerMetrics* metrics);
+bool IsRunPolicyValid(SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options);
+void PrintLog(SchedulerStats* stats, const char* format, ...);
+void PrintOutro(SchedulerStats* stats, AlgorithmData algorithm, const SchedulerMetrics* metrics, int procsCount, SchedulerCostModel costModel);
+void PrintSchedulerEvent(const SchedulerEvent* event, void* context);
+void PrintCounters(const char* label, SchedulerCounters counters);
+void PrintStats(const SchedulerStats* stats);
+bool WriteCheckpointInt(FILE* file, int value);
+bool ReadCheckpointInt(FILE* file, int* value);
+SchedulerError CreateCheckpointFile(const char* path, const Process procs[], int procsCount, int timeQuantum, SchedulerCostModel costModel, FILE** ofile);
+SchedulerError WriteCheckpoint(FILE* file, SchedulerPolicy policy, const SchedulerState* state, const ReadyQueue* queue, const SchedulerTimers* timers, int procsCount);
+bool ReadCheckpoint(FILE* file, int procsCount, int* policyIdx, SchedulerCheckpoint* checkpoint);
+SchedulerError LoadResumePoints(const char* path, const Process procs[], int procsCount, int timeQuantum, SchedulerCostModel costModel, SchedulerCheckpoints* checkpoints);
+void RestoreCheckpoint(const SchedulerCheckpoint* checkpoint, AlgorithmData algorithm, const Process procs[], int procsCount, SchedulerState* state, ReadyQueue* queue, SchedulerTimers* timers);
+SchedulerError RunAlgorithm(AlgorithmData algorithm, const Process procs[], int procsCount, SchedulerOptions options, SchedulerCheckpoints* checkpoints,
+                            Executor* executor, WorkloadPipeline* pipeline, SchedulerEventHandler onEvent, void* context, SchedulerMetrics* metrics);
 
 
 
-void HandleCPUScheduler(const char* processesCsvFilePath, int timeQuantum)
+/*
+ * The CLI's report: every policy's schedule on stdout, followed by the statistics, checkpoint and executor
+ * reports on stderr
+ */
+SchedulerError HandleCPUScheduler(const char* processesCsvFilePath, int timeQuantum, SchedulerOptions options)
 {
     int procsCount = 0;
     Process procs[MAX_PROC];
+    SchedulerStats stats = { 0 };
+    stats.output = stdout;
+    stats.isEnabled = options.shouldCollectStats;
+    struct timespec phaseStartingTime;
+    SchedulerError error = SCHEDULER_OK;
 
 
 
     /*
-     * Get procs from file
+     * Executor mode needs real time, children cannot be restored from a checkpoint, and the children already
+     * pay the real dispatch overhead. Checkpoints describe the whole workload, which a pipeline does not have
+     * when they are written.
      */
-    InitProcessesFromCSV(processesCsvFilePath, procs, &procsCount);
+    if (timeQuantum <= 0 || options.timeUnitNs < 0 || options.checkpointInterval <= 0 ||
+        options.costModel.switchCost < 0 || options.costModel.cacheRefillCost < 0 || options.costModel.cacheColdTime < 0 ||
+        (options.shouldExecute && (options.timeUnitNs == 0 || options.resumePath != NULL || IsCostModelEnabled(options.costModel))) ||
+        options.pipelineWindow < 0 || options.pipelineWindow > PIPELINE_MAX_WINDOW ||
+        (options.pipelineWindow > 0 && (options.checkpointPath != NULL || options.resumePath != NULL)))
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
 
 
 
     /*
-     * Sort procs (stable)
+     * Get procs from file, unless they are parsed while the first policy runs
      */
-    SortProcesses(procs, procsCount, ProcCmpArrivalTime);
-
-
+    phaseStartingTime = GetCurrentTime();
+    if (options.pipelineWindow == 0 && (error = InitProcessesFromCSV(processesCsvFilePath, procs, &procsCount)) != SCHEDULER_OK)
+        return error;
+    stats.csvLoadTime = GetTimeElapsed(phaseStartingTime);
 
     /*
-     * FCFS alg
+     * Checkpoints only know the flat ready queue
      */
-    AlgorithmData fcfs;
-    fcfs.CmpPriority = CmpPriorityNull;
-    fcfs.shouldPrintTotalWait = true;
-    fcfs.shouldPrintTurnaround = false;
-    fcfs.name = ALGORITHM_FCFS;
-    fcfs.maxUptime = -1;
-    RunAlgorithm(fcfs, procs, procsCount);
+    if ((options.checkpointPath != NULL || options.resumePath != NULL) && WorkloadHasGroups(procs, procsCount))
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
 
 
 
     /*
-     * SJF alg
+     * Find where each policy resumes from, then start writing the new checkpoints. Anything unusable in the old
+     * checkpoint only costs the resume, the policies then run from time zero.
      */
-    AlgorithmData sjf;
-    sjf.CmpPriority = CmpShortestBurst;
-    sjf.shouldPrintTotalWait = true;
-    sjf.shouldPrintTurnaround = false;
-    sjf.name = ALGORITHM_SJF;
-    sjf.maxUptime = -1;
-    RunAlgorithm(sjf, procs, procsCount);
+    SchedulerCheckpoints* checkpoints = calloc(1, sizeof(SchedulerCheckpoints));
+    if (checkpoints == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+    checkpoints->interval = options.checkpointInterval;
+    if (options.resumePath != NULL)
+    {
+        error = LoadResumePoints(options.resumePath, procs, procsCount, timeQuantum, options.costModel, checkpoints);
+        if (error == SCHEDULER_ERROR_PARSE)
+        {
+            fprintf(stderr, "Checkpoint %s does not match this workload, running from time 0\n", options.resumePath);
+            error = SCHEDULER_OK;
+        }
+    }
+    if (error == SCHEDULER_OK && options.checkpointPath != NULL)
+        error = CreateCheckpointFile(options.checkpointPath, procs, procsCount, timeQuantum, options.costModel, &checkpoints->file);
 
 
 
-    /*
-     * Priority alg
-     */
-    AlgorithmData priorityAlg;
-    priorityAlg.CmpPriority = CmpLowerPriority;
-    priorityAlg.shouldPrintTotalWait = true;
-    priorityAlg.shouldPrintTurnaround = false;
-    priorityAlg.name = ALGORITHM_PRIORITY;
-    priorityAlg.maxUptime = -1;
-    RunAlgorithm(priorityAlg, procs, procsCount);
+    Executor* executor = NULL;
+    if (error == SCHEDULER_OK && options.shouldExecute)
+    {
+        if (options.executorCpu != EXECUTOR_NO_CPU && !ExecutorPinToCpu(options.executorCpu))
+            error = SCHEDULER_ERROR_SYSTEM;
+        else if ((executor = calloc(1, sizeof(Executor))) == NULL)
+            error = SCHEDULER_ERROR_SYSTEM;
+        else
+            executor->timeUnitNs = options.timeUnitNs;
+    }
+
+    WorkloadPipeline* pipeline = NULL;
+    if (error == SCHEDULER_OK && options.pipelineWindow > 0)
+    {
+        if ((pipeline = WorkloadPipelineAlloc()) == NULL)
+            error = SCHEDULER_ERROR_SYSTEM;
+        else
+            error = WorkloadPipelineStart(pipeline, processesCsvFilePath, options.pipelineWindow, procs);
+    }
 
 
 
     /*
-     * RR alg
+     * Running every policy, each one wrapped in its introduction and summary
      */
-    AlgorithmData roundRobinAlg;
-    roundRobinAlg.CmpPriority = CmpPriorityNull;
-    roundRobinAlg.shouldPrintTotalWait = false;
-    roundRobinAlg.shouldPrintTurnaround = true;
-    roundRobinAlg.name = ALGORITHM_RR;
-    roundRobinAlg.maxUptime = timeQuantum;
-    RunAlgorithm(roundRobinAlg, procs, procsCount);
+    for (int policy = 0; error == SCHEDULER_OK && policy < SCHEDULER_POLICIES_COUNT; policy++)
+    {
+        AlgorithmData algorithm = GetAlgorithmData(policy, timeQuantum);
+        SchedulerMetrics* metrics = &stats.policyMetrics[stats.policiesCount];
+        stats.policyNames[stats.policiesCount++] = algorithm.name;
+
+        PrintLog(&stats, SCHEDULER_INTRO, algorithm.name);
+        if (checkpoints->hasResumePoint[policy])
+            fprintf(stderr, "Resuming %s from checkpoint at time %d\n", algorithm.name, checkpoints->resumePoints[policy].state.schedulerUptime);
+
+        error = RunAlgorithm(algorithm, procs, procsCount, options, checkpoints, executor, pipeline, PrintSchedulerEvent, &stats, metrics);
+        if (pipeline != NULL)
+        {
+            WorkloadPipelineEnd(pipeline, &procsCount);
+            stats.csvLoadTime = pipeline->parseTime;
+            free(pipeline);
+            pipeline = NULL;
+        }
+        if (error == SCHEDULER_OK)
+            PrintOutro(&stats, algorithm, metrics, procsCount, options.costModel);
+
+        if (executor != NULL)
+        {
+            if (error == SCHEDULER_OK)
+            {
+                fflush(stdout);
+                ExecutorPrintReport(executor, algorithm.name, stderr);
+            }
+            ExecutorEnd(executor);
+        }
+    }
+
+
+
+    if (checkpoints->file != NULL && fclose(checkpoints->file) != 0 && error == SCHEDULER_OK)
+        error = SCHEDULER_ERROR_SYSTEM;
+    free(checkpoints);
+    free(executor);
+    if (pipeline != NULL)
+        WorkloadPipelineEnd(pipeline, NULL);
+    free(pipeline);
+
+
+
+    if (error == SCHEDULER_OK && stats.isEnabled)
+        PrintStats(&stats);
+
+    return error;
+}
+
+/*
+ * Runs a single policy over procs, without checkpoints or an executor
+ */
+SchedulerError RunPolicy(SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options,
+                         SchedulerEventHandler onEvent, void* context, SchedulerMetrics* ometrics)
+{
+    if (!IsRunPolicyValid(policy, timeQuantum, procs, procsCount, options) || ometrics == NULL)
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+
+    return RunAlgorithm(GetAlgorithmData(policy, timeQuantum), procs, procsCount, options, NULL, NULL, NULL, onEvent, context, ometrics);
 }
 
+/*
+ * RunPolicy() printing the policy's report, exactly as HandleCPUScheduler() does, to 'output'
+ */
+SchedulerError PrintPolicyReport(FILE* output, SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options,
+                                 SchedulerMetrics* ometrics)
+{
+    if (!IsRunPolicyValid(policy, timeQuantum, procs, procsCount, options) || output == NULL || ometrics == NULL)
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+
+    SchedulerStats stats = { 0 };
+    stats.output = output;
+    AlgorithmData algorithm = GetAlgorithmData(policy, timeQuantum);
+
+    PrintLog(&stats, SCHEDULER_INTRO, algorithm.name);
+    SchedulerError error = RunAlgorithm(algorithm, procs, procsCount, options, NULL, NULL, NULL, PrintSchedulerEvent, &stats, ometrics);
+    if (error == SCHEDULER_OK)
+        PrintOutro(&stats, algorithm, ometrics, procsCount, options.costModel);
 
+    return error;
+}
 
-void InitProcessesFromCSV(const char* path, Process oprocs[], int* oprocsCount)
+bool IsRunPolicyValid(SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options)
 {
-    FILE* file = NULL;
+    return policy >= 0 && policy < SCHEDULER_POLICIES_COUNT && (policy != SCHEDULER_POLICY_ROUND_ROBIN || timeQuantum > 0) &&
+           procs != NULL && procsCount >= 0 && procsCount <= MAX_PROC && options.timeUnitNs >= 0 &&
+           options.costModel.switchCost >= 0 && options.costModel.cacheRefillCost >= 0 && options.costModel.cacheColdTime >= 0 &&
+           options.checkpointPath == NULL && options.resumePath == NULL && !options.shouldExecute && options.pipelineWindow == 0;
+}
 
-    if ((file = fopen(path, "r")) == NULL)
+const char* SchedulerErrorString(SchedulerError error)
+{
+    switch (error)
     {
-        perror("fopen() error:");
-        exit(EXIT_FAILURE);
+        case SCHEDULER_OK:
+            return "Success";
+        case SCHEDULER_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        case SCHEDULER_ERROR_PARSE:
+            return "Malformed process record";
+        case SCHEDULER_ERROR_TOO_MANY_PROCESSES:
+            return "Too many processes";
+        case SCHEDULER_ERROR_SYSTEM:
+            return "System error";
+        case SCHEDULER_ERROR_OUT_OF_ORDER:
+            return "Process arrives out of order beyond the reorder window";
+        case SCHEDULER_ERROR_NO_EVENTS:
+            return "No scheduler event in the trace";
+        case SCHEDULER_ERROR_TIME_OVERFLOW:
+            return "Time does not fit in the time unit, a coarser one is needed";
     }
 
+    return "Unknown error";
+}
+
+const char* SchedulerPolicyName(SchedulerPolicy policy)
+{
+    if (policy < 0 || policy >= SCHEDULER_POLICIES_COUNT)
+        return NULL;
+
+    return GetAlgorithmData(policy, 0).name;
+}
+
+AlgorithmData GetAlgorithmData(SchedulerPolicy policy, int timeQuantum)
+{
+    AlgorithmData algorithm;
+    algorithm.policy = policy;
+    algorithm.CmpPriority = CmpPriorityNull;
+    algorithm.shouldPrintTotalWait = true;
+    algorithm.shouldPrintTurnaround = false;
+    algorithm.maxUptime = -1;
+
+    switch (policy)
+    {
+        case SCHEDULER_POLICY_SJF:
+            algorithm.CmpPriority = CmpShortestBurst;
+            algorithm.name = ALGORITHM_SJF;
+            break;
+        case SCHEDULER_POLICY_PRIORITY:
+            algorithm.CmpPriority = CmpLowerPriority;
+            algorithm.name = ALGORITHM_PRIORITY;
+            break;
+        case SCHEDULER_POLICY_ROUND_ROBIN:
+            algorithm.shouldPrintTotalWait = false;
+            algorithm.shouldPrintTurnaround = true;
+            algorithm.name = ALGORITHM_RR;
+            algorithm.maxUptime = timeQuantum;
+            break;
+        default:
+            algorithm.name = ALGORITHM_FCFS;
+            break;
+    }
+
+    return algorithm;
+}
+
+
+
+SchedulerError InitProcessesFromCSV(const char* path, Process oprocs[], int* oprocsCount)
+{
+    FILE* file = NULL;
+    SchedulerError error = SCHEDULER_OK;
+
+    *oprocsCount = 0;
+    if ((file = fopen(path, "r")) == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+
 
 
     /*
@@ -186,92 +533,99 @@ void InitProcessesFromCSV(const char* path, Process oprocs[], int* oprocsCount)
      */
     char* line = NULL;
     size_t line_length = 0;
-    while (getline(&line, &line_length, file) > 0)
+    while (error == SCHEDULER_OK && getline(&line, &line_length, file) > 0)
     {
-        Process proc = ParseProcess(line);
+        if (*oprocsCount >= MAX_PROC)
+        {
+            error = SCHEDULER_ERROR_TOO_MANY_PROCESSES;
+            break;
+        }
+
+        Process proc;
+        if ((error = ParseProcess(line, &proc)) != SCHEDULER_OK)
+            break;
         proc.original_idx = *oprocsCount;
         oprocs[*oprocsCount] = proc;
         (*oprocsCount)++;
     }
 
-    if (ferror(file))
-    {
-        perror("fgets() error:");
-        exit(EXIT_FAILURE);
-    }
+    if (error == SCHEDULER_OK && ferror(file))
+        error = SCHEDULER_ERROR_SYSTEM;
 
 
 
     fclose(file);
     free(line);
+
+    return error;
 }
 
 
 
-Process ParseProcess(const char* line)
+SchedulerError ParseProcess(const char* line, Process* oproc)
 {
     char* save_ptr = NULL;
     char* dup = strdup(line);
-    char* currentValue = NULL;
+    char* fields[5];
     Process proc = { 0 };
 
+    if (dup == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
 
-    /*
-     * GETTING NAME
-     */
-    if ((currentValue = strtok_r(dup, CSV_DELIMS, &save_ptr)) == NULL)
-    {
-        perror("strtok_r() error");
-        exit(EXIT_FAILURE);
-    }
-    strcpy(proc.name, currentValue);
 
 
     /*
-     * GETTING DESC
+     * GETTING NAME, DESC, ARRIVAL TIME, BURST TIME AND PRIORITY
      */
-    if ((currentValue = strtok_r(NULL, CSV_DELIMS, &save_ptr)) == NULL)
-    {
-        perror("strtok_r() error");
-        exit(EXIT_FAILURE);
-    }
-    strcpy(proc.desc, currentValue);
-
-
+    for (int i = 0; i < 5; i++)
+        if ((fields[i] = strtok_r(i == 0 ? dup : NULL, CSV_DELIMS, &save_ptr)) == NULL)
+        {
+            free(dup);
+            return SCHEDULER_ERROR_PARSE;
+        }
 
-    /*
-     * GETTING ARRIVAL TIME
-     */
-    if ((currentValue = strtok_r(NULL, CSV_DELIMS, &save_ptr)) == NULL)
+    if (strlen(fields[0]) >= MAX_NAME || strlen(fields[1]) >= MAX_DESC)
     {
-        perror("strtok_r() error");
-        exit(EXIT_FAILURE);
+        free(dup);
+        return SCHEDULER_ERROR_PARSE;
     }
-    proc.arrival_time = atoi(currentValue);
+    strcpy(proc.name, fields[0]);
+    strcpy(proc.desc, fields[1]);
+    proc.arrival_time = atoi(fields[2]);
+    proc.burst_time = atoi(fields[3]);
+    proc.priority = atoi(fields[4]);
 
 
 
     /*
-     * GETTING BURST TIME
+     * GETTING THE OPTIONAL GROUP AND ITS WEIGHT
      */
-    if ((currentValue = strtok_r(NULL, CSV_DELIMS, &save_ptr)) == NULL)
+    char* group = strtok_r(NULL, CSV_DELIMS, &save_ptr);
+    if (group != NULL)
     {
-        perror("strtok_r() error");
-        exit(EXIT_FAILURE);
-    }
-    proc.burst_time = atoi(currentValue);
-
+        group += strspn(group, CSV_TRIMMED);
+        group[strcspn(group, CSV_TRIMMED)] = '\0';
 
-
-    /*
-     * GETTING PRIORITY
-     */
-    if ((currentValue = strtok_r(NULL, CSV_DELIMS, &save_ptr)) == NULL)
-    {
-        perror("strtok_r() error");
-        exit(EXIT_FAILURE);
+        char* weight = strchr(group, CSV_GROUP_WEIGHT_DELIM);
+        if (weight != NULL)
+        {
+            char* weightEnd = NULL;
+            *weight++ = '\0';
+            long groupWeight = strtol(weight, &weightEnd, 10);
+            if (weightEnd == weight || *weightEnd != '\0' || groupWeight <= 0 || groupWeight > MAX_GROUP_WEIGHT || *group == '\0')
+            {
+                free(dup);
+                return SCHEDULER_ERROR_PARSE;
+            }
+            proc.groupWeight = (int)groupWeight;
+        }
+        if (strlen(group) >= MAX_NAME)
+        {
+            free(dup);
+            return SCHEDULER_ERROR_PARSE;
+        }
+        strcpy(proc.group, group);
     }
-    proc.priority = atoi(currentValue);
 
 
 
@@ -279,7 +633,8 @@ Process ParseProcess(const char* line)
 
 
 
-    return proc;
+    *oproc = proc;
+    return SCHEDULER_OK;
 }
 
 int CmpPriorityNull(Process _, Process __)
@@ -297,19 +652,8 @@ int CmpLowerPriority(Process a, Process b)
     return a.priority - b.priority;
 }
 
-int ProcCmpArrivalTime(Process a, Process b)
-{
-    return a.arrival_time - b.arrival_time;
-}
-
-void SortProcesses(Process procs[], int procCount, int (*predicate)(Process, Process))
+void SortProcesses(Process procs[], int procCount, int (*predicate)(Process, Process), SchedulerCounters* counters)
 {
-    if (predicate == NULL)
-    {
-        fprintf(stderr, "Argument null error in function SortProcesses, 'predicate' cannot be null\n\n");
-        exit(EXIT_FAILURE);
-    }
-
     bool didSwap;
     do
     {
@@ -317,23 +661,32 @@ void SortProcesses(Process procs[], int procCount, int (*predicate)(Process, Pro
         for (int i = 0; i < procCount - 1; i++)
         {
             int cmpRes = predicate(procs[i], procs[i+1]);
+            if (counters != NULL)
+                counters->comparatorCalls++;
             if (cmpRes > 0)
             {
                 Process temp = procs[i];
                 procs[i] = procs[i+1];
                 procs[i+1] = temp;
                 didSwap = true;
+                if (counters != NULL)
+                    counters->elementMoves += 3;
             }
         }
     } while (didSwap);
 }
 
+/*
+ * The queue must not be empty
+ */
 Process Dequeue(ReadyQueue* queue)
 {
-    if (IsEmpty(*queue))
+    if (queue->groups != NULL)
     {
-        fprintf(stderr, "Invalid operation error: queue is already empty\n");
-        exit(EXIT_FAILURE);
+        queue->size--;
+        if (queue->counters != NULL)
+            queue->counters->dequeues++;
+        return GroupQueueDequeue(queue->groups);
     }
 
     Process firstProcess = queue->procs[0];
@@ -342,9 +695,18 @@ Process Dequeue(ReadyQueue* queue)
     for (int i = 0; i < queue->size; i++)
         queue->procs[i] = queue->procs[i+1];
 
+    if (queue->counters != NULL)
+    {
+        queue->counters->dequeues++;
+        queue->counters->elementMoves += queue->size;
+    }
+
     return firstProcess;
 }
 
+/*
+ * Every process is queued at most once, so the queue cannot overflow
+ */
 void Enqueue(ReadyQueue* queue, Process item)
 {
     if (LOG_LEVEL > 0)
@@ -352,186 +714,815 @@ void Enqueue(ReadyQueue* queue, Process item)
 
 
 
-    if (queue->size >= MAX_PROC)
+    if (queue->groups != NULL)
     {
-        fprintf(stderr, "Invalid operation error: queue is full\n");
-        exit(EXIT_FAILURE);
-    }
-    if (queue->CmpPriority == NULL)
-    {
-        fprintf(stderr, "Argument null error in function Enqueue, 'queue->CmpPriority' cannot be null\n");
-        exit(EXIT_FAILURE);
+        queue->size++;
+        if (queue->counters != NULL)
+            queue->counters->enqueues++;
+        GroupQueueEnqueue(queue->groups, item);
+        return;
     }
 
     queue->procs[queue->size] = item;
     queue->size++;
-    SortProcesses(queue->procs, queue->size, queue->CmpPriority);
+    if (queue->counters != NULL)
+    {
+        queue->counters->enqueues++;
+        queue->counters->elementMoves++;
+    }
+    SortProcesses(queue->procs, queue->size, queue->CmpPriority, queue->counters);
 }
 
-double GetTimeElapsed(struct timespec startingTime)
+struct timespec GetCurrentTime()
 {
     struct timespec currentTime;
 
-    if (clock_gettime(CLOCK_MONOTONIC, &currentTime) != 0)
-    {
-        perror("clock_gettime error");
-        exit(EXIT_FAILURE);
-    }
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+    return currentTime;
+}
+
+double GetTimeElapsed(struct timespec startingTime)
+{
+    struct timespec currentTime = GetCurrentTime();
 
     return  (double) (currentTime.tv_sec - startingTime.tv_sec) +
             (double) (currentTime.tv_nsec - startingTime.tv_nsec) / 1e9;
 }
 
-void EnqueueNewArrivals(ReadyQueue* queue, Process procs[], int* startingIdx, int procCount, int uptime)
+/*
+ * How long a process keeps the CPU once dispatched: its whole burst, or one time quantum if that is shorter
+ */
+int GetRunLength(AlgorithmData algorithm, Process process)
+{
+    if (algorithm.maxUptime != -1 && algorithm.maxUptime < process.burst_time)
+        return algorithm.maxUptime;
+
+    return process.burst_time;
+}
+
+bool IsCostModelEnabled(SchedulerCostModel costModel)
+{
+    return costModel.switchCost > 0 || costModel.cacheRefillCost > 0;
+}
+
+/*
+ * The time the CPU spends before process 'processIdx' actually runs once dispatched at state->schedulerUptime.
+ * Picking the process which just left the CPU again costs nothing.
+ */
+int GetDispatchOverhead(SchedulerCostModel costModel, const SchedulerState* state, int processIdx)
+{
+    int overhead = processIdx != state->lastProcessIdx ? costModel.switchCost : 0;
+
+    int lastRunEnd = state->lastRunEnd[processIdx];
+    if (lastRunEnd == -1)
+        overhead += costModel.cacheRefillCost;
+    else
+    {
+        int offCpuTime = state->schedulerUptime - lastRunEnd;
+        if (offCpuTime >= costModel.cacheColdTime)
+            overhead += costModel.cacheRefillCost;
+        else
+            overhead += (int)((long long)costModel.cacheRefillCost * offCpuTime / costModel.cacheColdTime);
+    }
+
+    return overhead;
+}
+
+void OnTimerExpiry(TimerWheelEntry entry, void* context)
+{
+    SchedulerTimers* timers = context;
+
+    /*
+     * Dispatch timers only exist to wake the main loop up, which checks the running process itself
+     */
+    if (entry.kind != TIMER_ARRIVAL)
+        return;
+
+    timers->pendingArrivals--;
+    timers->hasArrived[entry.payload] = true;
+    Enqueue(timers->queue, timers->procs[entry.payload]);
+
+    if (timers->executor != NULL && timers->error == SCHEDULER_OK)
+    {
+        const Process* proc = &timers->procs[entry.payload];
+        if (!ExecutorSpawn(timers->executor, entry.payload, proc->name, proc->burst_time))
+            timers->error = SCHEDULER_ERROR_SYSTEM;
+    }
+}
+
+/*
+ * Enqueues every process which arrived up to (and including) uptime. Processes arriving at the same time are
+ * enqueued in the order they appear in the CSV.
+ */
+SchedulerError EnqueueNewArrivals(SchedulerTimers* timers, int uptime)
+{
+    TimerWheelAdvance(&timers->wheel, uptime, OnTimerExpiry, timers);
+
+    return timers->error;
+}
+
+/*
+ * Whether every arrival up to 'time' (-1 for none) is in the wheel. With a pipeline, that is once a record
+ * arriving after it was released, and some arrival has to be known while records are still coming, so that the
+ * main loop does not take the workload for finished.
+ */
+bool IsTimeSettled(const SchedulerTimers* timers, int time)
+{
+    const WorkloadPipeline* pipeline = timers->pipeline;
+
+    return pipeline == NULL || pipeline->isDrained ||
+           (timers->pendingArrivals > 0 && time != -1 && time < pipeline->watermark);
+}
+
+/*
+ * Moves the pipeline's next record into the wheel, waiting for the parser if needed
+ */
+SchedulerError ReleaseArrival(SchedulerTimers* timers)
+{
+    const Process* proc = NULL;
+    SchedulerError error = WorkloadPipelineNext(timers->pipeline, &proc);
+
+    if (error == SCHEDULER_OK && proc != NULL)
+    {
+        timers->pendingArrivals++;
+        timers->hasArrived[proc->original_idx] = false;
+        TimerWheelInsert(&timers->wheel, proc->arrival_time, TIMER_ARRIVAL, proc->original_idx);
+    }
+
+    return error;
+}
+
+bool IsEmpty(ReadyQueue queue)
+{
+    return queue.size == 0;
+}
+
+SchedulerOptions DefaultSchedulerOptions()
+{
+    SchedulerOptions options = { 0 };
+    options.timeUnitNs = TIME_UNIT_NS;
+    options.checkpointInterval = CHECKPOINT_DEFAULT_INTERVAL;
+    options.executorCpu = EXECUTOR_NO_CPU;
+    options.costModel.cacheColdTime = CACHE_DEFAULT_COLD_TIME;
+
+    return options;
+}
+
+/*
+ * Parses a time unit such as "1s", "1ms", "10us" or "500ns" (a bare number is taken as nanoseconds).
+ * Returns -1 if the text is not a valid non negative duration.
+ */
+long ParseTimeUnit(const char* text)
+{
+    char* suffix = NULL;
+    errno = 0;
+    long value = strtol(text, &suffix, 10);
+    if (errno != 0 || suffix == text || value < 0)
+        return -1;
+
+    long multiplier;
+    if (strcmp(suffix, "") == 0 || strcmp(suffix, "ns") == 0)
+        multiplier = 1L;
+    else if (strcmp(suffix, "us") == 0)
+        multiplier = 1000L;
+    else if (strcmp(suffix, "ms") == 0)
+        multiplier = 1000000L;
+    else if (strcmp(suffix, "s") == 0)
+        multiplier = 1000000000L;
+    else
+        return -1;
+
+    if (value > 0 && multiplier > LONG_MAX / value)
+        return -1;
+
+    return value * multiplier;
+}
+
+/*
+ * Sleeps until the absolute deadline startingTime + uptime time units. Since every deadline is derived from
+ * startingTime rather than from the previous wakeup, lateness never accumulates between events.
+ */
+SchedulerError WaitUntil(struct timespec startingTime, int uptime, SchedulerOptions options, SchedulerMetrics* metrics)
+{
+    if (options.timeUnitNs == 0)
+        return SCHEDULER_OK;
+
+    struct timespec deadline = startingTime;
+    long long deadlineNs = (long long)deadline.tv_nsec + (long long)uptime * options.timeUnitNs;
+    deadline.tv_sec += deadlineNs / 1000000000L;
+    deadline.tv_nsec = deadlineNs % 1000000000L;
+
+    int error;
+    while ((error = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL)) == EINTR);
+    if (error != 0)
+    {
+        errno = error;
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+
+
+
+    if (options.shouldCollectStats)
+    {
+        struct timespec currentTime = GetCurrentTime();
+        long latencyNs = (long)(currentTime.tv_sec - deadline.tv_sec) * 1000000000L + (currentTime.tv_nsec - deadline.tv_nsec);
+        int bucket = 0;
+        while (bucket < JITTER_BUCKETS - 1 && latencyNs >= (1000L << bucket))
+            bucket++;
+
+        metrics->wakeups++;
+        metrics->wakeupJitter[bucket]++;
+        if (latencyNs > metrics->maxWakeupLatencyNs)
+            metrics->maxWakeupLatencyNs = latencyNs;
+    }
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * printf() which, when statistics are enabled, also accounts the time spent writing the report
+ */
+void PrintLog(SchedulerStats* stats, const char* format, ...)
+{
+    struct timespec printStartingTime;
+    va_list args;
+
+    if (stats->isEnabled)
+        printStartingTime = GetCurrentTime();
+
+    va_start(args, format);
+    vfprintf(stats->output, format, args);
+    va_end(args);
+
+    if (stats->isEnabled)
+        stats->outputTime += GetTimeElapsed(printStartingTime);
+}
+
+/*
+ * A policy's summary, with the dispatch overhead once a cost model is set
+ */
+void PrintOutro(SchedulerStats* stats, AlgorithmData algorithm, const SchedulerMetrics* metrics, int procsCount, SchedulerCostModel costModel)
+{
+    double overheadShare = metrics->turnaroundTime > 0 ? 100.0 * metrics->overheadTime / metrics->turnaroundTime : 0.0;
+
+    if (!IsCostModelEnabled(costModel))
+    {
+        if (algorithm.shouldPrintTotalWait)
+            PrintLog(stats, SCHEDULER_OUTRO_TOTAL_WAIT, (double)metrics->totalWaitingTime / procsCount);
+        if (algorithm.shouldPrintTurnaround)
+            PrintLog(stats, SCHEDULER_OUTRO_TURNAROUND, metrics->turnaroundTime);
+    }
+    else
+    {
+        if (algorithm.shouldPrintTotalWait)
+            PrintLog(stats, SCHEDULER_OUTRO_TOTAL_WAIT_OVERHEAD, (double)metrics->totalWaitingTime / procsCount, metrics->overheadTime, overheadShare);
+        if (algorithm.shouldPrintTurnaround)
+            PrintLog(stats, SCHEDULER_OUTRO_TURNAROUND_OVERHEAD, metrics->turnaroundTime, metrics->overheadTime, overheadShare);
+    }
+
+    if (metrics->groupsCount > 0)
+        PrintLog(stats, SCHEDULER_OUTRO_GROUPS);
+    for (int i = 0; i < metrics->groupsCount; i++)
+    {
+        const SchedulerGroupMetrics* group = &metrics->groups[i];
+        PrintLog(stats, SCHEDULER_OUTRO_GROUP, i == metrics->groupsCount - 1 ? "└─" : "├─",
+                 group->name[0] != '\0' ? group->name : SCHEDULER_OUTRO_UNGROUPED,
+                 group->weight, group->processesCount, group->averageWaitingTime, group->turnaroundTime);
+    }
+    PrintLog(stats, SCHEDULER_OUTRO_END);
+}
+
+/*
+ * The CLI's event handler, 'context' being its SchedulerStats
+ */
+void PrintSchedulerEvent(const SchedulerEvent* event, void* context)
+{
+    if (event->kind == SCHEDULER_EVENT_RUN)
+        PrintLog(context, PROC_LOG, event->start, event->end, event->process->name, event->process->desc);
+    else if (event->kind == SCHEDULER_EVENT_SWITCH)
+        PrintLog(context, SWITCH_LOG, event->start, event->end, event->process->name);
+    else
+        PrintLog(context, IDLE_LOG, event->start, event->end);
+}
+
+void PrintCounters(const char* label, SchedulerCounters counters)
+{
+    fprintf(stderr, STATS_COUNTERS,
+            label, counters.enqueues, counters.dequeues, counters.comparatorCalls, counters.elementMoves,
+            "", counters.contextSwitches, counters.idleIntervals, counters.loopIterations);
+}
+
+/*
+ * The report goes to stderr so that the schedule printed to stdout stays untouched
+ */
+void PrintStats(const SchedulerStats* stats)
 {
+    fflush(stdout);
+    fprintf(stderr, STATS_INTRO);
+    fprintf(stderr, STATS_PHASE, "CSV load", stats->csvLoadTime);
+    for (int i = 0; i < stats->policiesCount; i++)
+        fprintf(stderr, STATS_PHASE, stats->policyNames[i], stats->policyMetrics[i].runTime);
+    fprintf(stderr, STATS_PHASE, "Output", stats->outputTime);
+    fprintf(stderr, "\n");
+
+    for (int i = 0; i < stats->policiesCount; i++)
+        PrintCounters(stats->policyNames[i], stats->policyMetrics[i].counters);
+
+
+
     /*
-     * Validating that there is a process to add
+     * The jitter histogram covers the wakeups of every policy
      */
-    if (*startingIdx >= procCount)
+    long wakeups = 0;
+    long maxWakeupLatencyNs = 0;
+    long wakeupJitter[JITTER_BUCKETS] = { 0 };
+    for (int i = 0; i < stats->policiesCount; i++)
+    {
+        const SchedulerMetrics* metrics = &stats->policyMetrics[i];
+        wakeups += metrics->wakeups;
+        if (metrics->maxWakeupLatencyNs > maxWakeupLatencyNs)
+            maxWakeupLatencyNs = metrics->maxWakeupLatencyNs;
+        for (int j = 0; j < JITTER_BUCKETS; j++)
+            wakeupJitter[j] += metrics->wakeupJitter[j];
+    }
+
+    if (wakeups > 0)
+    {
+        fprintf(stderr, STATS_JITTER_INTRO, wakeups, maxWakeupLatencyNs / 1e6);
+        for (int i = 0; i < JITTER_BUCKETS - 1; i++)
+            if (wakeupJitter[i] > 0)
+                fprintf(stderr, STATS_JITTER_BUCKET, "", 1L << i, wakeupJitter[i]);
+        if (wakeupJitter[JITTER_BUCKETS - 1] > 0)
+            fprintf(stderr, STATS_JITTER_OVERFLOW, "", 1L << (JITTER_BUCKETS - 1), wakeupJitter[JITTER_BUCKETS - 1]);
+    }
+    fprintf(stderr, STATS_OUTRO);
+}
+
+
+/*
+ * Checkpoint file layout, every field being a native int:
+ * header:  magic, version, time quantum, the cost model, process count, then arrival/burst/priority of every
+ *          process
+ * records: policy index, the SchedulerState fields, the running process' index, the ready queue as
+ *          (index, arrival, burst) triplets, every process' last run end and a pending flag per process, packed
+ *          as bits
+ */
+bool WriteCheckpointInt(FILE* file, int value)
+{
+    int32_t stored = value;
+
+    return fwrite(&stored, sizeof(stored), 1, file) == 1;
+}
+
+bool ReadCheckpointInt(FILE* file, int* value)
+{
+    int32_t stored;
+    if (fread(&stored, sizeof(stored), 1, file) != 1)
+        return false;
+
+    *value = stored;
+    return true;
+}
+
+SchedulerError CreateCheckpointFile(const char* path, const Process procs[], int procsCount, int timeQuantum, SchedulerCostModel costModel, FILE** ofile)
+{
+    FILE* file = NULL;
+    if ((file = fopen(path, "wb")) == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+
+    bool isWritten = fwrite(CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC), 1, file) == 1 &&
+                     WriteCheckpointInt(file, CHECKPOINT_VERSION) &&
+                     WriteCheckpointInt(file, timeQuantum) &&
+                     WriteCheckpointInt(file, costModel.switchCost) &&
+                     WriteCheckpointInt(file, costModel.cacheRefillCost) &&
+                     WriteCheckpointInt(file, costModel.cacheColdTime) &&
+                     WriteCheckpointInt(file, procsCount);
+    for (int i = 0; isWritten && i < procsCount; i++)
+    {
+        isWritten = WriteCheckpointInt(file, procs[i].arrival_time) &&
+                    WriteCheckpointInt(file, procs[i].burst_time) &&
+                    WriteCheckpointInt(file, procs[i].priority);
+    }
+
+    if (!isWritten)
+    {
+        fclose(file);
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+
+    *ofile = file;
+    return SCHEDULER_OK;
+}
+
+SchedulerError WriteCheckpoint(FILE* file, SchedulerPolicy policy, const SchedulerState* state, const ReadyQueue* queue, const SchedulerTimers* timers, int procsCount)
+{
+    bool isWritten = WriteCheckpointInt(file, policy) &&
+                     WriteCheckpointInt(file, state->schedulerUptime) &&
+                     WriteCheckpointInt(file, state->iteration) &&
+                     WriteCheckpointInt(file, state->isProcessRunning) &&
+                     WriteCheckpointInt(file, state->isProcessRunning ? state->runningProcess.original_idx : -1) &&
+                     WriteCheckpointInt(file, state->runningProcess.arrival_time) &&
+                     WriteCheckpointInt(file, state->runningProcess.burst_time) &&
+                     WriteCheckpointInt(file, state->processStartingTime) &&
+                     WriteCheckpointInt(file, state->isIdling) &&
+                     WriteCheckpointInt(file, state->idleTimeStart) &&
+                     WriteCheckpointInt(file, state->totalWaitingTime) &&
+                     WriteCheckpointInt(file, state->overheadTime) &&
+                     WriteCheckpointInt(file, state->lastProcessIdx) &&
+                     WriteCheckpointInt(file, queue->size);
+
+    for (int i = 0; isWritten && i < queue->size; i++)
     {
-        fprintf(stderr, "Invalid argument error: startingIdx = %d when there are only %d processes\n", *startingIdx, procCount);
-        exit(EXIT_FAILURE);
+        isWritten = WriteCheckpointInt(file, queue->procs[i].original_idx) &&
+                    WriteCheckpointInt(file, queue->procs[i].arrival_time) &&
+                    WriteCheckpointInt(file, queue->procs[i].burst_time);
     }
 
+    for (int i = 0; isWritten && i < procsCount; i++)
+        isWritten = WriteCheckpointInt(file, state->lastRunEnd[i]);
+
+    for (int i = 0; isWritten && i < procsCount; i += 8)
+    {
+        unsigned char bits = 0;
+        for (int j = i; j < i + 8 && j < procsCount; j++)
+            if (!timers->hasArrived[j])
+                bits |= 1 << (j - i);
+        isWritten = fputc(bits, file) != EOF;
+    }
+
+    return isWritten ? SCHEDULER_OK : SCHEDULER_ERROR_SYSTEM;
+}
+
+/*
+ * Reads the next record. Returns false at the end of the file, or if the record is truncated or malformed.
+ */
+bool ReadCheckpoint(FILE* file, int procsCount, int* policyIdx, SchedulerCheckpoint* checkpoint)
+{
+    int isProcessRunning;
+    int isIdling;
+    SchedulerState* state = &checkpoint->state;
+
+    checkpoint->procsCount = procsCount;
+    if (!ReadCheckpointInt(file, policyIdx) ||
+        !ReadCheckpointInt(file, &state->schedulerUptime) ||
+        !ReadCheckpointInt(file, &state->iteration) ||
+        !ReadCheckpointInt(file, &isProcessRunning) ||
+        !ReadCheckpointInt(file, &checkpoint->runningIdx) ||
+        !ReadCheckpointInt(file, &state->runningProcess.arrival_time) ||
+        !ReadCheckpointInt(file, &state->runningProcess.burst_time) ||
+        !ReadCheckpointInt(file, &state->processStartingTime) ||
+        !ReadCheckpointInt(file, &isIdling) ||
+        !ReadCheckpointInt(file, &state->idleTimeStart) ||
+        !ReadCheckpointInt(file, &state->totalWaitingTime) ||
+        !ReadCheckpointInt(file, &state->overheadTime) ||
+        !ReadCheckpointInt(file, &state->lastProcessIdx) ||
+        !ReadCheckpointInt(file, &checkpoint->queueSize))
+        return false;
+    state->isProcessRunning = isProcessRunning;
+    state->isIdling = isIdling;
+    state->turnaroundTime = 0;
+
+    if (*policyIdx < 0 || *policyIdx >= MAX_POLICIES || checkpoint->queueSize < 0 || checkpoint->queueSize > procsCount ||
+        state->lastProcessIdx < -1 || state->lastProcessIdx >= procsCount ||
+        (state->isProcessRunning && (checkpoint->runningIdx < 0 || checkpoint->runningIdx >= procsCount)))
+        return false;
+
+    for (int i = 0; i < checkpoint->queueSize; i++)
+        if (!ReadCheckpointInt(file, &checkpoint->queue[i].originalIdx) ||
+            !ReadCheckpointInt(file, &checkpoint->queue[i].arrivalTime) ||
+            !ReadCheckpointInt(file, &checkpoint->queue[i].burstTime) ||
+            checkpoint->queue[i].originalIdx < 0 || checkpoint->queue[i].originalIdx >= procsCount)
+            return false;
+
+    for (int i = 0; i < procsCount; i++)
+        if (!ReadCheckpointInt(file, &state->lastRunEnd[i]))
+            return false;
+
+    for (int i = 0; i < procsCount; i += 8)
+    {
+        int bits = fgetc(file);
+        if (bits == EOF)
+            return false;
+        for (int j = i; j < i + 8 && j < procsCount; j++)
+            checkpoint->isArrivalPending[j] = (bits >> (j - i)) & 1;
+    }
+
+    return true;
+}
+
+/*
+ * Picks, for every policy, the latest checkpoint taken before the first process whose record differs from the
+ * checkpointed workload arrived. Nothing before that arrival can depend on the change, so the run may continue
+ * from there. Returns SCHEDULER_ERROR_PARSE if the header does not match this workload.
+ */
+SchedulerError LoadResumePoints(const char* path, const Process procs[], int procsCount, int timeQuantum, SchedulerCostModel costModel, SchedulerCheckpoints* checkpoints)
+{
+    FILE* file = NULL;
+    if ((file = fopen(path, "rb")) == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+
 
 
     /*
-     * Adding processes to ReadyQueue
+     * Validating the header and finding the first time the workloads differ
      */
-    for (; *startingIdx < procCount; (*startingIdx)++)
-        if (procs[*startingIdx].arrival_time <= uptime)
+    char magic[sizeof(CHECKPOINT_MAGIC)] = { 0 };
+    int version;
+    int checkpointQuantum;
+    SchedulerCostModel checkpointCostModel;
+    int checkpointProcsCount;
+    if (fread(magic, strlen(CHECKPOINT_MAGIC), 1, file) != 1 || strcmp(magic, CHECKPOINT_MAGIC) != 0 ||
+        !ReadCheckpointInt(file, &version) || version != CHECKPOINT_VERSION ||
+        !ReadCheckpointInt(file, &checkpointQuantum) || checkpointQuantum != timeQuantum ||
+        !ReadCheckpointInt(file, &checkpointCostModel.switchCost) || checkpointCostModel.switchCost != costModel.switchCost ||
+        !ReadCheckpointInt(file, &checkpointCostModel.cacheRefillCost) || checkpointCostModel.cacheRefillCost != costModel.cacheRefillCost ||
+        !ReadCheckpointInt(file, &checkpointCostModel.cacheColdTime) || checkpointCostModel.cacheColdTime != costModel.cacheColdTime ||
+        !ReadCheckpointInt(file, &checkpointProcsCount) || checkpointProcsCount < 0 || checkpointProcsCount > MAX_PROC)
+    {
+        fclose(file);
+        return SCHEDULER_ERROR_PARSE;
+    }
+
+    int changedFrom = INT_MAX;
+    for (int i = 0; i < checkpointProcsCount; i++)
+    {
+        int arrivalTime, burstTime, priority;
+        if (!ReadCheckpointInt(file, &arrivalTime) || !ReadCheckpointInt(file, &burstTime) || !ReadCheckpointInt(file, &priority))
         {
-            if (queue->CmpPriority == NULL)
-            {
-                fprintf(stderr, "Argument null error in function EnqueueNewArrivals, 'queue->CmpPriority' cannot be null\n");
-                exit(EXIT_FAILURE);
-            }
-            Enqueue(queue, procs[*startingIdx]);
+            fclose(file);
+            return SCHEDULER_ERROR_PARSE;
         }
-        else break;
+
+        if (i >= procsCount)
+            changedFrom = arrivalTime < changedFrom ? arrivalTime : changedFrom;
+        else if (arrivalTime != procs[i].arrival_time || burstTime != procs[i].burst_time || priority != procs[i].priority)
+        {
+            int firstArrival = arrivalTime < procs[i].arrival_time ? arrivalTime : procs[i].arrival_time;
+            changedFrom = firstArrival < changedFrom ? firstArrival : changedFrom;
+        }
+    }
+    for (int i = checkpointProcsCount; i < procsCount; i++)
+        changedFrom = procs[i].arrival_time < changedFrom ? procs[i].arrival_time : changedFrom;
+
+
+
+    /*
+     * Keeping the latest usable record of every policy
+     */
+    SchedulerCheckpoint* record = malloc(sizeof(SchedulerCheckpoint));
+    if (record == NULL)
+    {
+        fclose(file);
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+
+    int policyIdx;
+    while (ReadCheckpoint(file, checkpointProcsCount, &policyIdx, record))
+    {
+        if (record->state.schedulerUptime > changedFrom)
+            continue;
+        if (checkpoints->hasResumePoint[policyIdx] &&
+            checkpoints->resumePoints[policyIdx].state.schedulerUptime > record->state.schedulerUptime)
+            continue;
+
+        checkpoints->resumePoints[policyIdx] = *record;
+        checkpoints->hasResumePoint[policyIdx] = true;
+    }
+
+
+
+    free(record);
+    fclose(file);
+
+    return SCHEDULER_OK;
 }
 
-bool IsEmpty(ReadyQueue queue)
+/*
+ * Rebuilds a run from its checkpoint on top of the (possibly modified) workload
+ */
+void RestoreCheckpoint(const SchedulerCheckpoint* checkpoint, AlgorithmData algorithm, const Process procs[], int procsCount, SchedulerState* state, ReadyQueue* queue, SchedulerTimers* timers)
 {
-    return queue.size == 0;
-}
+    *state = checkpoint->state;
+    for (int i = checkpoint->procsCount; i < procsCount; i++)
+        state->lastRunEnd[i] = -1;
+    if (state->isProcessRunning)
+    {
+        state->runningProcess = procs[checkpoint->runningIdx];
+        state->runningProcess.arrival_time = checkpoint->state.runningProcess.arrival_time;
+        state->runningProcess.burst_time = checkpoint->state.runningProcess.burst_time;
+    }
 
-void SigAlarmHandler() {  }
 
 
-void RunAlgorithm(AlgorithmData algorithm, Process procs[], int procsCount)
+    /*
+     * The checkpointed queue is already in priority order
+     */
+    queue->size = checkpoint->queueSize;
+    for (int i = 0; i < checkpoint->queueSize; i++)
+    {
+        queue->procs[i] = procs[checkpoint->queue[i].originalIdx];
+        queue->procs[i].arrival_time = checkpoint->queue[i].arrivalTime;
+        queue->procs[i].burst_time = checkpoint->queue[i].burstTime;
+    }
+
+
+
+    /*
+     * Processes the checkpoint does not know about (appended to the workload since) have not arrived yet either
+     */
+    timers->pendingArrivals = 0;
+    for (int i = 0; i < procsCount; i++)
+    {
+        timers->hasArrived[i] = i < checkpoint->procsCount && !checkpoint->isArrivalPending[i];
+        if (!timers->hasArrived[i])
+        {
+            timers->pendingArrivals++;
+            TimerWheelInsert(&timers->wheel, procs[i].arrival_time, TIMER_ARRIVAL, i);
+        }
+    }
+
+    if (state->isProcessRunning)
+    {
+        TimerWheelInsert(&timers->wheel, state->processStartingTime + GetRunLength(algorithm, state->runningProcess),
+                         TIMER_DISPATCH_END, state->runningProcess.original_idx);
+    }
+}
+
+/*
+ * Runs one policy, reporting every process run and idle interval to onEvent. 'checkpoints', 'executor' and
+ * 'pipeline' may be NULL, a pipeline filling procs as the run goes (procsCount is then ignored). On error, an
+ * executor and a pipeline still have to be ended by the caller.
+ */
+SchedulerError RunAlgorithm(AlgorithmData algorithm, const Process procs[], int procsCount, SchedulerOptions options, SchedulerCheckpoints* checkpoints,
+                            Executor* executor, WorkloadPipeline* pipeline, SchedulerEventHandler onEvent, void* context, SchedulerMetrics* metrics)
 {
+    SchedulerError error = SCHEDULER_OK;
+    SchedulerEvent event = { 0 };
+    memset(metrics, 0, offsetof(SchedulerMetrics, groups));
+    SchedulerCounters* counters = &metrics->counters;
+    struct timespec policyStartingTime = GetCurrentTime();
+
+
+
     /*
      * Initialise Ready Queue (FCFS)
      */
     ReadyQueue queue;
     queue.size = 0;
     queue.CmpPriority = algorithm.CmpPriority;
-    if (queue.CmpPriority == NULL)
-    {
-        fprintf(stderr, "null after init\n");
-        exit(EXIT_FAILURE);
-    }
-
-
+    queue.counters = counters;
+    queue.groups = NULL;
 
     /*
-     * Ignoring sigalarms, we use them as a waiting mechanism
+     * A pipeline's workload is not known yet, its processes all go to the unnamed group if it has none
      */
-    struct sigaction act;
-    act.sa_handler = SigAlarmHandler;
-    act.sa_flags = 0;
-    sigemptyset(&act.sa_mask);
-    sigaction(SIGALRM, &act, NULL);
+    if (pipeline != NULL || WorkloadHasGroups(procs, procsCount))
+    {
+        if ((queue.groups = malloc(sizeof(GroupQueue))) == NULL)
+            return SCHEDULER_ERROR_SYSTEM;
+        GroupQueueInit(queue.groups, algorithm.CmpPriority, algorithm.maxUptime, counters);
+    }
 
 
 
     /*
-     * Print introduction
+     * Scheduling every arrival, the CSV does not have to be sorted. A what-if run instead continues from its
+     * checkpoint, with only the arrivals which were still pending back in the wheel, and a pipelined run only
+     * starts once the arrivals at time 0 are known.
      */
-    printf(SCHEDULER_INTRO, algorithm.name);
+    SchedulerState state = { 0 };
+    state.idleTimeStart = -1;
+    state.lastProcessIdx = -1;
+    for (int i = 0; i < MAX_PROC; i++)
+        state.lastRunEnd[i] = -1;
+    SchedulerTimers* timers = malloc(sizeof(SchedulerTimers));
+    if (timers == NULL)
+    {
+        free(queue.groups);
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+    TimerWheelInit(&timers->wheel, 0);
+    timers->procs = procs;
+    timers->queue = &queue;
+    timers->executor = executor;
+    timers->pipeline = pipeline;
+    timers->error = SCHEDULER_OK;
+
+    if (checkpoints != NULL && checkpoints->hasResumePoint[algorithm.policy])
+        RestoreCheckpoint(&checkpoints->resumePoints[algorithm.policy], algorithm, procs, procsCount, &state, &queue, timers);
+    else if (pipeline != NULL)
+    {
+        timers->pendingArrivals = 0;
+        while (error == SCHEDULER_OK && !IsTimeSettled(timers, 0))
+            error = ReleaseArrival(timers);
+    }
+    else
+    {
+        timers->pendingArrivals = procsCount;
+        for (int i = 0; i < procsCount; i++)
+        {
+            timers->hasArrived[i] = false;
+            TimerWheelInsert(&timers->wheel, procs[i].arrival_time, TIMER_ARRIVAL, i);
+        }
+    }
 
 
 
     /*
-     * Start timer
+     * Start timer, backdated to the resumed time so that deadlines stay absolute
      */
-    struct timespec startingTime;
-    if (clock_gettime(CLOCK_MONOTONIC, &startingTime) != 0)
+    struct timespec startingTime = GetCurrentTime();
+    long long resumedNs = (long long)state.schedulerUptime * options.timeUnitNs;
+    startingTime.tv_sec -= resumedNs / 1000000000L;
+    startingTime.tv_nsec -= resumedNs % 1000000000L;
+    if (startingTime.tv_nsec < 0)
     {
-        perror("clock_gettime() error");
-        exit(EXIT_FAILURE);
+        startingTime.tv_sec--;
+        startingTime.tv_nsec += 1000000000L;
     }
+    int nextCheckpointTime = state.schedulerUptime;
+    if (error == SCHEDULER_OK && executor != NULL && !ExecutorBegin(executor, startingTime))
+        error = SCHEDULER_ERROR_SYSTEM;
 
 
 
     /*
-     * Main loop which runs every tick (1 second) and:
+     * Main loop which wakes up at every scheduling event (an arrival, a burst completing or a time quantum
+     * expiring) and:
      * Enqueues new processes
      * Checks if the process currently running has finished
      *
+     * The clock is logical: schedulerUptime is the time unit of the event being handled, and the wall clock
+     * is only used to sleep until that event's absolute deadline.
      */
-    int startingIdx = 0;
-    Process runningProcess;
-    bool isProcessRunning = false;
-    bool isIdling = false;
-    struct timespec processStartingTime;
-    bool isProcessNotArrived = startingIdx < procsCount;
-    int turnaroundTime = 0;
-    int totalWaitingTime = 0;
-    int iteration = 0;
-    int idleTimeStart = -1;
+    bool isProcessNotArrived = timers->pendingArrivals > 0;
 
-    while (isProcessNotArrived || IsEmpty(queue) || isProcessRunning)
+    while (error == SCHEDULER_OK && (isProcessNotArrived || IsEmpty(queue) || state.isProcessRunning))
     {
-        int processUptime = isProcessRunning ? (int)GetTimeElapsed(processStartingTime) : -1;
-        int schedulerUptime = (int)GetTimeElapsed(startingTime);
-        isProcessNotArrived = startingIdx < procsCount;
+        if (checkpoints != NULL && checkpoints->file != NULL && state.schedulerUptime >= nextCheckpointTime)
+        {
+            if ((error = WriteCheckpoint(checkpoints->file, algorithm.policy, &state, &queue, timers, procsCount)) != SCHEDULER_OK)
+                break;
+            nextCheckpointTime = state.schedulerUptime - state.schedulerUptime % checkpoints->interval + checkpoints->interval;
+        }
+        if ((error = WaitUntil(startingTime, state.schedulerUptime, options, metrics)) != SCHEDULER_OK)
+            break;
+        int processUptime = state.isProcessRunning ? state.schedulerUptime - state.processStartingTime : -1;
+        isProcessNotArrived = timers->pendingArrivals > 0;
 
 
 
         if (LOG_LEVEL > 0)
-            fprintf(stdout, "Starting iteration. currentlyRunningProcess: %s, isProcessNotArrived: %s\n", isProcessRunning ? runningProcess.name : "NULL", isProcessNotArrived ? "true" : "false");
+            fprintf(stdout, "Starting state.iteration. currentlyRunningProcess: %s, isProcessNotArrived: %s\n", state.isProcessRunning ? state.runningProcess.name : "NULL", isProcessNotArrived ? "true" : "false");
 
 
 
 
         if (isProcessNotArrived)
         {
-            if (queue.CmpPriority == NULL)
-            {
-                fprintf(stderr, "Argument null error in function HandleCPUScheduler, 'queue.CmpPriority' cannot be null (iteration %d)\n", iteration);
-                exit(EXIT_FAILURE);
-            }
             /*
              * Only adding processes from the previous second. This is scuffed because of the changes to how round robin should work.
              * Added the minus one second to account for the fact that I would only like to add process which were supposed to be added a second before
              */
-            EnqueueNewArrivals(&queue, procs, &startingIdx, procsCount, isProcessRunning ? schedulerUptime - 1 : schedulerUptime);
-            isProcessNotArrived = startingIdx < procsCount;
+            if ((error = EnqueueNewArrivals(timers, state.isProcessRunning ? state.schedulerUptime - 1 : state.schedulerUptime)) != SCHEDULER_OK)
+                break;
+            isProcessNotArrived = timers->pendingArrivals > 0;
         }
 
 
 
 
-        if (isProcessRunning)
+        if (state.isProcessRunning)
         {
-            bool wasRunningProcessChanged = false;
-            if (processUptime >= runningProcess.burst_time)
+            if (processUptime >= state.runningProcess.burst_time)
             {
                 /*
                  * Adding to totalWaitingTime
                  */
-                totalWaitingTime += schedulerUptime - runningProcess.burst_time - runningProcess.arrival_time;
-                isProcessRunning = false;
-                wasRunningProcessChanged = true;
+                int waitingTime = state.schedulerUptime - state.runningProcess.burst_time - state.runningProcess.arrival_time;
+                state.totalWaitingTime += waitingTime;
+                if (queue.groups != NULL)
+                    GroupQueueAccount(queue.groups, state.runningProcess.original_idx, waitingTime, state.schedulerUptime);
+                state.isProcessRunning = false;
+                state.lastRunEnd[state.runningProcess.original_idx] = state.schedulerUptime;
+                if (executor != NULL && !ExecutorFinish(executor, state.runningProcess.original_idx, state.schedulerUptime))
+                {
+                    error = SCHEDULER_ERROR_SYSTEM;
+                    break;
+                }
 
 
 
                 /*
-                 * Printing process log
+                 * Reporting the process' run
                  */
-                printf(PROC_LOG, schedulerUptime - runningProcess.burst_time, schedulerUptime, runningProcess.name, runningProcess.desc);
+                event.kind = SCHEDULER_EVENT_RUN;
+                event.start = state.schedulerUptime - state.runningProcess.burst_time;
+                event.end = state.schedulerUptime;
+                event.process = &state.runningProcess;
+                if (onEvent != NULL)
+                    onEvent(&event, context);
 
 
 
@@ -543,7 +1534,7 @@ void RunAlgorithm(AlgorithmData algorithm, Process procs[], int procsCount)
 
                     if (LOG_LEVEL > 0)
                         fprintf(stdout, "Last process finished, terminating.\n");
-                    turnaroundTime = schedulerUptime;
+                    state.turnaroundTime = state.schedulerUptime;
                     break;
                 }
             }
@@ -552,105 +1543,158 @@ void RunAlgorithm(AlgorithmData algorithm, Process procs[], int procsCount)
                 if (processUptime >= algorithm.maxUptime)
                 {
                     if (LOG_LEVEL > 0)
-                        fprintf(stdout, "Process %s finished its timequantom without completing its burst. Re-adding to queue.\n", runningProcess.name);
+                        fprintf(stdout, "Process %s finished its timequantom without completing its burst. Re-adding to queue.\n", state.runningProcess.name);
 
 
 
                     /*
                      * Adding to totalWaitingTime
                      */
-                    totalWaitingTime += schedulerUptime - algorithm.maxUptime - runningProcess.arrival_time;
-                    isProcessRunning = false;
-                    wasRunningProcessChanged = true;
-
+                    int waitingTime = state.schedulerUptime - algorithm.maxUptime - state.runningProcess.arrival_time;
+                    state.totalWaitingTime += waitingTime;
+                    if (queue.groups != NULL)
+                        GroupQueueAccount(queue.groups, state.runningProcess.original_idx, waitingTime, -1);
+                    state.isProcessRunning = false;
+                    state.lastRunEnd[state.runningProcess.original_idx] = state.schedulerUptime;
+                    if (executor != NULL && !ExecutorPause(executor, state.runningProcess.original_idx))
+                    {
+                        error = SCHEDULER_ERROR_SYSTEM;
+                        break;
+                    }
 
 
                     /*
-                     * Printing process log
+                     * Reporting the process' run
                      */
-                    printf(PROC_LOG, schedulerUptime - algorithm.maxUptime, schedulerUptime, runningProcess.name, runningProcess.desc);
+                    event.kind = SCHEDULER_EVENT_RUN;
+                    event.start = state.schedulerUptime - algorithm.maxUptime;
+                    event.end = state.schedulerUptime;
+                    event.process = &state.runningProcess;
+                    if (onEvent != NULL)
+                        onEvent(&event, context);
 
 
 
                     /*
                      * Process did not finish entire burst. Adjusting it and re-adding to queue
                      */
-                    Process modifiedProcess = runningProcess;
-                    modifiedProcess.arrival_time = schedulerUptime;
+                    Process modifiedProcess = state.runningProcess;
+                    modifiedProcess.arrival_time = state.schedulerUptime;
                     modifiedProcess.burst_time -= algorithm.maxUptime;
                     Enqueue(&queue, modifiedProcess);
                 }
             }
-            if (isProcessNotArrived && wasRunningProcessChanged)
-            {
-                if (queue.CmpPriority == NULL)
-                {
-                    fprintf(stderr, "Argument null error in function HandleCPUScheduler, 'queue.CmpPriority' cannot be null (iteration %d)\n", iteration);
-                    exit(EXIT_FAILURE);
-                }
-                EnqueueNewArrivals(&queue, procs, &startingIdx, procsCount, schedulerUptime);
-                isProcessNotArrived = startingIdx < procsCount;
-            }
+            /*
+             * Arrivals of this very unit go after the process which was just preempted. If the running process did not
+             * change, the loop woke up for an arrival and enqueueing it now or at the next event is the same.
+             * This also expires the dispatch timer.
+             */
+            if ((error = EnqueueNewArrivals(timers, state.schedulerUptime)) != SCHEDULER_OK)
+                break;
+            isProcessNotArrived = timers->pendingArrivals > 0;
         }
 
 
 
-        if (!isProcessRunning && !IsEmpty(queue))
+        if (!state.isProcessRunning && !IsEmpty(queue))
         {
-            if (isIdling)
+            if (state.isIdling)
             {
                 /*
-                 * Printing idle log
+                 * Reporting the idle interval
                  */
-                printf(IDLE_LOG, idleTimeStart, schedulerUptime);
-                isIdling = false;
-                idleTimeStart = -1;
+                event.kind = SCHEDULER_EVENT_IDLE;
+                event.start = state.idleTimeStart;
+                event.end = state.schedulerUptime;
+                event.process = NULL;
+                if (onEvent != NULL)
+                    onEvent(&event, context);
+                state.isIdling = false;
+                state.idleTimeStart = -1;
             }
-            isProcessRunning = true;
-            if (clock_gettime(CLOCK_MONOTONIC, &processStartingTime) != 0)
+            state.isProcessRunning = true;
+            state.runningProcess = Dequeue(&queue);
+            counters->contextSwitches++;
+
+
+
+            /*
+             * The process only starts once the CPU is done with the dispatch overhead
+             */
+            int overhead = GetDispatchOverhead(options.costModel, &state, state.runningProcess.original_idx);
+            state.processStartingTime = state.schedulerUptime + overhead;
+            state.overheadTime += overhead;
+            state.lastProcessIdx = state.runningProcess.original_idx;
+            if (overhead > 0 && onEvent != NULL)
+            {
+                event.kind = SCHEDULER_EVENT_SWITCH;
+                event.start = state.schedulerUptime;
+                event.end = state.processStartingTime;
+                event.process = &state.runningProcess;
+                onEvent(&event, context);
+            }
+            if (executor != NULL && !ExecutorResume(executor, state.runningProcess.original_idx, state.processStartingTime))
             {
-                perror("clock_gettime() error");
-                exit(EXIT_FAILURE);
+                error = SCHEDULER_ERROR_SYSTEM;
+                break;
             }
-            runningProcess = Dequeue(&queue);
+
+
+
+            /*
+             * Waking up when the burst completes or the time quantum expires, whichever comes first
+             */
+            TimerWheelInsert(&timers->wheel, state.processStartingTime + GetRunLength(algorithm, state.runningProcess),
+                             TIMER_DISPATCH_END, state.runningProcess.original_idx);
 
 
 
             if (LOG_LEVEL > 0)
-                fprintf(stdout, "Started running %s to queue.\n", runningProcess.name);
+                fprintf(stdout, "Started running %s to queue.\n", state.runningProcess.name);
         }
 
 
 
 
-        if (!isProcessRunning && IsEmpty(queue) && isProcessNotArrived && !isIdling)
+        if (!state.isProcessRunning && IsEmpty(queue) && isProcessNotArrived && !state.isIdling)
         {
             if (LOG_LEVEL > 0)
                 fprintf(stdout, "Started idling.\n");
-            isIdling = true;
-            idleTimeStart = schedulerUptime;
+            state.isIdling = true;
+            state.idleTimeStart = state.schedulerUptime;
+            counters->idleIntervals++;
         }
 
-        iteration++;
-        ualarm((int)1e5, 0);
-        pause();
-    }
+        state.iteration++;
+        counters->loopIterations++;
+
 
 
+        /*
+         * Advancing the clock to the next event in the timing wheel: an arrival, or the running process' burst
+         * completing or time quantum expiring. A pipeline may still have to release earlier arrivals.
+         */
+        int nextEvent = TimerWheelNextExpiry(&timers->wheel);
+        while (!IsTimeSettled(timers, nextEvent) && (error = ReleaseArrival(timers)) == SCHEDULER_OK)
+            nextEvent = TimerWheelNextExpiry(&timers->wheel);
+        if (error != SCHEDULER_OK || nextEvent == -1)
+            break;
+        state.schedulerUptime = nextEvent;
+    }
 
-    if (algorithm.shouldPrintTotalWait)
-        printf(SCHEDULER_OUTRO_TOTAL_WAIT, (double)totalWaitingTime / procsCount);
-    if (algorithm.shouldPrintTurnaround)
-        printf(SCHEDULER_OUTRO_TURNAROUND, turnaroundTime);
 
 
+    if (pipeline != NULL)
+        procsCount = pipeline->procsCount;
+    metrics->totalWaitingTime = state.totalWaitingTime;
+    metrics->averageWaitingTime = procsCount > 0 ? (double)state.totalWaitingTime / procsCount : 0.0;
+    metrics->turnaroundTime = state.turnaroundTime;
+    metrics->overheadTime = state.overheadTime;
+    metrics->runTime = GetTimeElapsed(policyStartingTime);
+    if (queue.groups != NULL && WorkloadHasGroups(procs, procsCount))
+        metrics->groupsCount = GroupQueueGetMetrics(queue.groups, metrics->groups);
+    free(queue.groups);
+    free(timers);
 
-    /*
-     * Restoring the sigalarm handler
-     */
-    struct sigaction act_restore;
-    act_restore.sa_handler = SIG_DFL;
-    act_restore.sa_flags = 0;
-    sigemptyset(&act_restore.sa_mask);
-    sigaction(SIGALRM, &act_restore, NULL);
+    return error;
 }
@@ -0,0 +1,198 @@
+#ifndef CPU_SCHEDULER_H
+#define CPU_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * The scheduling engine (libscheduler). A workload is loaded once and can then be run under any policy, every
+ * line of the resulting schedule being reported to an event handler and the run's totals to a SchedulerMetrics.
+ *
+ * No function exits the process: errors are returned as a SchedulerError, and SCHEDULER_ERROR_SYSTEM leaves
+ * errno as the failing call set it.
+ */
+
+/*
+ * Default length of a single time unit in nanoseconds, see ParseTimeUnit() for overriding it
+ */
+#define TIME_UNIT_NS 1000000000L
+
+/*
+ * The library is built with hidden visibility, only the functions marked SCHEDULER_API are exported
+ */
+#define SCHEDULER_API __attribute__((visibility("default")))
+
+/*
+ * Wakeup jitter histogram: bucket i counts wakeups which were late by less than 2^i microseconds,
+ * the last bucket takes everything above
+ */
+#define JITTER_BUCKETS 21
+
+#define MAX_NAME 51
+#define MAX_DESC 101
+#define MAX_PROC 1000
+#define MAX_GROUPS MAX_PROC
+#define MAX_GROUP_WEIGHT 1000000
+
+/*
+ * Reorder window of a pipelined load when none is given, see SchedulerOptions.pipelineWindow
+ */
+#define PIPELINE_DEFAULT_WINDOW 16
+
+
+/*
+ * 'group' comes from the optional sixth CSV column, "<group>[:<weight>]", and is empty for processes without one.
+ * groupWeight is 0 when the column gives none.
+ */
+typedef struct
+{
+    char name[MAX_NAME];
+    char desc[MAX_DESC];
+    int arrival_time;
+    int burst_time;
+    int priority;
+    int original_idx;
+    char group[MAX_NAME];
+    int groupWeight;
+} Process;
+
+typedef enum
+{
+    SCHEDULER_OK,
+    SCHEDULER_ERROR_INVALID_ARGUMENT,
+    SCHEDULER_ERROR_PARSE,
+    SCHEDULER_ERROR_TOO_MANY_PROCESSES,
+    SCHEDULER_ERROR_SYSTEM,
+    SCHEDULER_ERROR_OUT_OF_ORDER,
+    SCHEDULER_ERROR_NO_EVENTS,
+    SCHEDULER_ERROR_TIME_OVERFLOW
+} SchedulerError;
+
+/*
+ * In the order HandleCPUScheduler() runs them, which is also how checkpoints identify them
+ */
+typedef enum
+{
+    SCHEDULER_POLICY_FCFS,
+    SCHEDULER_POLICY_SJF,
+    SCHEDULER_POLICY_PRIORITY,
+    SCHEDULER_POLICY_ROUND_ROBIN,
+    SCHEDULER_POLICIES_COUNT
+} SchedulerPolicy;
+
+/*
+ * Hot path counters. A "move" is a single Process copy inside the queue or a sort.
+ */
+typedef struct
+{
+    long enqueues;
+    long dequeues;
+    long comparatorCalls;
+    long elementMoves;
+    long contextSwitches;
+    long idleIntervals;
+    long loopIterations;
+} SchedulerCounters;
+
+typedef enum
+{
+    SCHEDULER_EVENT_RUN,
+    SCHEDULER_EVENT_IDLE,
+    SCHEDULER_EVENT_SWITCH
+} SchedulerEventKind;
+
+/*
+ * One line of the schedule: 'process' ran, the CPU idled, or the CPU spent the dispatch overhead of 'process',
+ * from 'start' to 'end'. 'process' is NULL for idle events and only valid while the handler runs.
+ */
+typedef struct
+{
+    SchedulerEventKind kind;
+    int start;
+    int end;
+    const Process* process;
+} SchedulerEvent;
+
+typedef void (*SchedulerEventHandler)(const SchedulerEvent* event, void* context);
+
+/*
+ * A group's share of a run: turnaroundTime is when its last process completed. The unnamed group holds the
+ * processes without a group column.
+ */
+typedef struct
+{
+    char name[MAX_NAME];
+    int weight;
+    int processesCount;
+    int totalWaitingTime;
+    double averageWaitingTime;
+    int turnaroundTime;
+} SchedulerGroupMetrics;
+
+/*
+ * What a single run measured. runTime is in wall clock seconds, and the wakeup fields are only filled when
+ * shouldCollectStats is set and time is not scaled to 0. Workloads with groups are scheduled by group first
+ * (see Group-Queue.h), and only then are groupsCount and groups filled, in the order the groups first queued.
+ */
+typedef struct
+{
+    int totalWaitingTime;
+    double averageWaitingTime;
+    int turnaroundTime;
+    int overheadTime;
+    double runTime;
+    SchedulerCounters counters;
+    long wakeups;
+    long maxWakeupLatencyNs;
+    long wakeupJitter[JITTER_BUCKETS];
+    int groupsCount;
+    SchedulerGroupMetrics groups[MAX_GROUPS];
+} SchedulerMetrics;
+
+/*
+ * Dispatch overhead, in time units, which occupies the CPU before the dispatched process runs: switchCost
+ * whenever the CPU switches to another process, plus a cache refill penalty growing linearly with the time the
+ * process has been off the CPU, up to cacheRefillCost once that reaches cacheColdTime (or if it never ran).
+ * All zeros, the default, makes dispatching free.
+ */
+typedef struct
+{
+    int switchCost;
+    int cacheRefillCost;
+    int cacheColdTime;
+} SchedulerCostModel;
+
+/*
+ * timeUnitNs is the wall clock length of one time unit. 0 runs the simulation without sleeping at all.
+ * shouldExecute backs every process with a real child process (see Executor.c), pinned to executorCpu unless
+ * it is EXECUTOR_NO_CPU. pipelineWindow, if not 0, parses the workload while the first policy already runs, which
+ * only works for workloads ordered by arrival up to that many records (see Workload-Pipeline.h) and not with
+ * checkpoints. Checkpoints, the executor and pipelining are only supported by HandleCPUScheduler().
+ */
+typedef struct
+{
+    bool shouldCollectStats;
+    long timeUnitNs;
+    const char* checkpointPath;
+    int checkpointInterval;
+    const char* resumePath;
+    bool shouldExecute;
+    int executorCpu;
+    SchedulerCostModel costModel;
+    int pipelineWindow;
+} SchedulerOptions;
+
+
+SCHEDULER_API SchedulerOptions DefaultSchedulerOptions();
+SCHEDULER_API long ParseTimeUnit(const char* text);
+SCHEDULER_API const char* SchedulerErrorString(SchedulerError error);
+SCHEDULER_API const char* SchedulerPolicyName(SchedulerPolicy policy);
+SCHEDULER_API SchedulerError InitProcessesFromCSV(const char* path, Process oprocs[], int* oprocsCount);
+SCHEDULER_API SchedulerError ParseProcess(const char* line, Process* oproc);
+SCHEDULER_API SchedulerError RunPolicy(SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options,
+                                       SchedulerEventHandler onEvent, void* context, SchedulerMetrics* ometrics);
+SCHEDULER_API SchedulerError PrintPolicyReport(FILE* output, SchedulerPolicy policy, int timeQuantum, const Process procs[], int procsCount, SchedulerOptions options,
+                                               SchedulerMetrics* ometrics);
+SCHEDULER_API SchedulerError HandleCPUScheduler(const char* processesCsvFilePath, int timeQuantum, SchedulerOptions options);
+
+#endif
@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Executor.h"
+
+#define EXECUTOR_INTRO \
+"══════════════════════════════════════════════\n" \
+">> Executor Report : %s\n" \
+"──────────────────────────────────────────────\n"
+#define EXECUTOR_LATENCY            "   %-29s : %ld, avg %9.3f us, max %9.3f us\n"
+#define EXECUTOR_PROCESS_INTRO      "\n   %-16s %12s %12s %12s\n"
+#define EXECUTOR_PROCESS            "   %-16s %12d %12.3f %+12.3f\n"
+#define EXECUTOR_OUTRO              "══════════════════════════════════════════════\n"
+
+
+long long GetMonotonicNs();
+void ExecutorCollectSlice(Executor* executor, int idx);
+void ExecutorMeasureAdd(ExecutorMeasure* measure, long long ns);
+void ExecutorRunChild(ExecutorSharedSlot* slot, long long budgetNs);
+
+
+
+long long GetMonotonicNs()
+{
+    struct timespec currentTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+    return (long long)currentTime.tv_sec * 1000000000LL + currentTime.tv_nsec;
+}
+
+/*
+ * Pins the calling process, and therefore every child it forks afterwards, to a single core so that the
+ * children really compete for one CPU like the simulated processes do
+ */
+bool ExecutorPinToCpu(int cpu)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+bool ExecutorBegin(Executor* executor, struct timespec startingTime)
+{
+    executor->startingNs = (long long)startingTime.tv_sec * 1000000000LL + startingTime.tv_nsec;
+    executor->childrenCount = 0;
+    memset(&executor->dispatchLatency, 0, sizeof(ExecutorMeasure));
+    memset(&executor->stopOverhead, 0, sizeof(ExecutorMeasure));
+    memset(&executor->startDivergence, 0, sizeof(ExecutorMeasure));
+    memset(&executor->endDivergence, 0, sizeof(ExecutorMeasure));
+
+    executor->shared = mmap(NULL, EXECUTOR_MAX_CHILDREN * sizeof(ExecutorSharedSlot), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (executor->shared == MAP_FAILED)
+    {
+        executor->shared = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Forks the child of process 'idx' when it arrives. The child stops itself right away and only runs once it is
+ * dispatched.
+ */
+bool ExecutorSpawn(Executor* executor, int idx, const char* name, int burstTime)
+{
+    if (idx >= EXECUTOR_MAX_CHILDREN)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    ExecutorSharedSlot* slot = &executor->shared[idx];
+    slot->resumedAtNs = -1;
+    slot->finishedAtNs = 0;
+
+    pid_t pid = fork();
+    if (pid == -1)
+        return false;
+    if (pid == 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        raise(SIGSTOP);
+        ExecutorRunChild(slot, (long long)burstTime * executor->timeUnitNs);
+    }
+
+
+
+    /*
+     * Waiting for the child to be stopped before it counts as ready
+     */
+    int status;
+    if (waitpid(pid, &status, WUNTRACED) == -1)
+        return false;
+    if (!WIFSTOPPED(status))
+    {
+        errno = ECHILD;
+        return false;
+    }
+
+    executor->children[idx].pid = pid;
+    executor->children[idx].name = name;
+    executor->children[idx].hasExited = false;
+    executor->children[idx].simulatedEnd = -1;
+    if (idx >= executor->childrenCount)
+        executor->childrenCount = idx + 1;
+
+    return true;
+}
+
+bool ExecutorResume(Executor* executor, int idx, int simulatedStart)
+{
+    ExecutorChild* child = &executor->children[idx];
+
+    executor->shared[idx].resumedAtNs = 0;
+    executor->sliceStart = simulatedStart;
+    executor->continuedAtNs = GetMonotonicNs();
+
+    return kill(child->pid, SIGCONT) == 0;
+}
+
+/*
+ * Collects the measurements of the slice which ended. The child is stopped or reaped by then, so it stamped its
+ * resume time if it ever got the CPU during the slice.
+ */
+void ExecutorCollectSlice(Executor* executor, int idx)
+{
+    long long resumedAtNs = executor->shared[idx].resumedAtNs;
+    if (resumedAtNs <= 0)
+        return;
+
+    ExecutorMeasureAdd(&executor->dispatchLatency, resumedAtNs - executor->continuedAtNs);
+    ExecutorMeasureAdd(&executor->startDivergence, resumedAtNs - (executor->startingNs + (long long)executor->sliceStart * executor->timeUnitNs));
+}
+
+/*
+ * Preempts the child, the overhead being the time until the kernel reports it as stopped
+ */
+bool ExecutorPause(Executor* executor, int idx)
+{
+    ExecutorChild* child = &executor->children[idx];
+    long long stoppingAtNs = GetMonotonicNs();
+    int status;
+
+    if (kill(child->pid, SIGSTOP) != 0 || waitpid(child->pid, &status, WUNTRACED) == -1)
+        return false;
+    ExecutorMeasureAdd(&executor->stopOverhead, GetMonotonicNs() - stoppingAtNs);
+    ExecutorCollectSlice(executor, idx);
+
+
+
+    /*
+     * The child may have used up its CPU budget before the simulation expected it to
+     */
+    if (WIFEXITED(status) || WIFSIGNALED(status))
+        child->hasExited = true;
+
+    return true;
+}
+
+/*
+ * The simulation says the burst is over, waiting for the child to actually be done with it
+ */
+bool ExecutorFinish(Executor* executor, int idx, int simulatedEnd)
+{
+    ExecutorChild* child = &executor->children[idx];
+    child->simulatedEnd = simulatedEnd;
+
+    if (!child->hasExited)
+    {
+        int status;
+        while (waitpid(child->pid, &status, 0) == -1)
+            if (errno != EINTR)
+                return false;
+        child->hasExited = true;
+    }
+    ExecutorCollectSlice(executor, idx);
+
+    ExecutorMeasureAdd(&executor->endDivergence,
+                       executor->shared[idx].finishedAtNs - (executor->startingNs + (long long)simulatedEnd * executor->timeUnitNs));
+
+    return true;
+}
+
+void ExecutorPrintReport(const Executor* executor, const char* algorithmName, FILE* stream)
+{
+    fprintf(stream, EXECUTOR_INTRO, algorithmName);
+
+    ExecutorMeasure measures[] = { executor->dispatchLatency, executor->stopOverhead, executor->startDivergence, executor->endDivergence };
+    const char* labels[] = { "Dispatch latency (SIGCONT)", "Preemption overhead (SIGSTOP)", "Slice start divergence", "Completion divergence" };
+    for (int i = 0; i < 4; i++)
+        fprintf(stream, EXECUTOR_LATENCY, labels[i], measures[i].count,
+                measures[i].count > 0 ? (double)measures[i].totalNs / measures[i].count / 1e3 : 0.0, measures[i].maxNs / 1e3);
+
+    fprintf(stream, EXECUTOR_PROCESS_INTRO, "Process", "Simulated", "Observed", "Difference");
+    for (int i = 0; i < executor->childrenCount; i++)
+    {
+        const ExecutorChild* child = &executor->children[i];
+        if (child->simulatedEnd == -1)
+            continue;
+
+        double observedEnd = (double)(executor->shared[i].finishedAtNs - executor->startingNs) / executor->timeUnitNs;
+        fprintf(stream, EXECUTOR_PROCESS, child->name, child->simulatedEnd, observedEnd, observedEnd - child->simulatedEnd);
+    }
+    fprintf(stream, EXECUTOR_OUTRO);
+}
+
+/*
+ * Reaps every child that is left. It is safe to call after any executor call failed, and keeps that call's errno.
+ */
+void ExecutorEnd(Executor* executor)
+{
+    int savedErrno = errno;
+
+    for (int i = 0; i < executor->childrenCount; i++)
+        if (executor->children[i].pid > 0 && !executor->children[i].hasExited)
+        {
+            kill(executor->children[i].pid, SIGKILL);
+            waitpid(executor->children[i].pid, NULL, 0);
+        }
+    memset(executor->children, 0, sizeof(executor->children));
+    executor->childrenCount = 0;
+
+    if (executor->shared != NULL)
+        munmap(executor->shared, EXECUTOR_MAX_CHILDREN * sizeof(ExecutorSharedSlot));
+    executor->shared = NULL;
+    errno = savedErrno;
+}
+
+void ExecutorMeasureAdd(ExecutorMeasure* measure, long long ns)
+{
+    long long absoluteNs = ns < 0 ? -ns : ns;
+
+    measure->count++;
+    measure->totalNs += absoluteNs;
+    if (absoluteNs > measure->maxNs)
+        measure->maxNs = absoluteNs;
+}
+
+/*
+ * The child's body: burns CPU until it used budgetNs of it. The CPU clock does not advance while the child is
+ * stopped, so only the time it was dispatched counts.
+ */
+void ExecutorRunChild(ExecutorSharedSlot* slot, long long budgetNs)
+{
+    struct timespec cpuTime;
+
+    do
+    {
+        if (slot->resumedAtNs == 0)
+            slot->resumedAtNs = GetMonotonicNs();
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuTime) != 0)
+            _exit(EXIT_FAILURE);
+    } while ((long long)cpuTime.tv_sec * 1000000000LL + cpuTime.tv_nsec < budgetNs);
+
+    slot->finishedAtNs = GetMonotonicNs();
+    _exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,70 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <time.h>
+
+/*
+ * Executor mode: every process of the workload is backed by a real, CPU bound child process which the scheduler
+ * stops and continues (SIGSTOP/SIGCONT) according to the simulated schedule. Each child spins until it has used
+ * burst_time time units of CPU, so comparing what the children actually did with the simulated timeline shows
+ * what dispatching costs on a real kernel.
+ *
+ * Functions returning bool return false on a failed system call, with errno set.
+ */
+#define EXECUTOR_MAX_CHILDREN 1024
+#define EXECUTOR_NO_CPU -1
+
+/*
+ * Written by the children, read by the scheduler. A child stamps resumedAtNs the first time it runs after the
+ * scheduler zeroed it, which the scheduler does right before every SIGCONT.
+ */
+typedef struct
+{
+    volatile long long resumedAtNs;
+    volatile long long finishedAtNs;
+} ExecutorSharedSlot;
+
+typedef struct
+{
+    pid_t pid;
+    const char* name;
+    bool hasExited;
+    int simulatedEnd;
+} ExecutorChild;
+
+typedef struct
+{
+    long count;
+    long long totalNs;
+    long long maxNs;
+} ExecutorMeasure;
+
+typedef struct
+{
+    long timeUnitNs;
+    long long startingNs;
+    ExecutorSharedSlot* shared;
+    ExecutorChild children[EXECUTOR_MAX_CHILDREN];
+    int childrenCount;
+    long long continuedAtNs;
+    int sliceStart;
+    ExecutorMeasure dispatchLatency;
+    ExecutorMeasure stopOverhead;
+    ExecutorMeasure startDivergence;
+    ExecutorMeasure endDivergence;
+} Executor;
+
+
+bool ExecutorPinToCpu(int cpu);
+bool ExecutorBegin(Executor* executor, struct timespec startingTime);
+bool ExecutorSpawn(Executor* executor, int idx, const char* name, int burstTime);
+bool ExecutorResume(Executor* executor, int idx, int simulatedStart);
+bool ExecutorPause(Executor* executor, int idx);
+bool ExecutorFinish(Executor* executor, int idx, int simulatedEnd);
+void ExecutorPrintReport(const Executor* executor, const char* algorithmName, FILE* stream);
+void ExecutorEnd(Executor* executor);
+
+#endif
@@ -1,6 +1,21 @@
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Focus-Mode.h"
 
 #define SESSION_OUTRO "\nFocus Mode complete. All distractions are now unblocked.\n"
 #define FIRST_ROUND_INTRO "Entering Focus Mode. All distractions are blocked.\n"
@@ -19,311 +34,976 @@
     "        Checking pending distractions...      \n" \
     "──────────────────────────────────────────────\n"
 #define DISTRACTIONS_INTRO_EMPTY "No distractions reached you this round.\n"
+#define DISTRACTION_TEXT " - %s\n"
+#define DISTRACTION_OUTCOME "[Outcome:] %s\n"
+#define DISTRACTION_COUNT "[Arrivals:] %d\n"
 
-#define GET_MESSAGE_PROMPT \
-    "\nSimulate a distraction:\n" \
-    "  1 = Email notification\n" \
-    "  2 = Reminder to pick up delivery\n" \
-    "  3 = Doorbell Ringing\n" \
+#define GET_MESSAGE_PROMPT "\nSimulate a distraction:\n"
+#define GET_MESSAGE_PROMPT_ENTRY "  %c = %s\n"
+#define GET_MESSAGE_PROMPT_QUIT \
     "  q = Quit\n" \
-    ">> " \
+    ">> "
 
-#define SIGNAL_EMAIL                            SIGUSR1
-#define SIGNAL_DELIVERY                         SIGUSR2
-#define SIGNAL_DOORBELL                         SIGINT
+/*
+ * Scripted replay: the script's messages are replayed in a loop for as many rounds as asked, without prompts and
+ * with stdout written in large blocks
+ */
+#define REPLAY_BUFFER_SIZE                      (1 << 20)
+#define REPLAY_COMMENT                          '#'
+#define REPLAY_REPORT                           "Replayed %d rounds (%ld distractions) in %.3f s: %.0f rounds/s\n"
+
+/*
+ * Timed rounds last Round-Duration seconds instead of Round-Duration distractions
+ */
+#define ROUND_TIME_UP                           "\nTime is up.\n"
+
+#define FOCUS_INPUT_SIZE                        4096
+#define FOCUS_EVENTS_COUNT                      4
+#define FOCUS_SIGNALS_BATCH                     64
+
+/*
+ * Load mode's report. Latencies are kept in a log-linear histogram, LATENCY_SUB_BUCKETS per power of two, so the
+ * percentiles are exact to within 1/LATENCY_SUB_BUCKETS.
+ */
+#define LOAD_INTRO                              "Focus-Load: %d generators sending %d signals/s each for %d s\n"
+#define LOAD_SENT                               "Sent:       %ld (%ld dropped, the signal queue being full)\n"
+#define LOAD_RECEIVED                           "Received:   %ld (%ld coalesced)\n"
+#define LOAD_THROUGHPUT                         "Throughput: %.0f signals/s\n"
+#define LOAD_LATENCY                            "Latency:    p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n"
+#define LOAD_COUNT                              " - %s: %ld\n"
+#define LATENCY_SUB_BUCKETS_BITS                4
+#define LATENCY_SUB_BUCKETS                     (1 << LATENCY_SUB_BUCKETS_BITS)
+#define LATENCY_BUCKETS_COUNT                   (64 * LATENCY_SUB_BUCKETS)
+#define NS_PER_SECOND                           1000000000LL
+
+#define CATALOG_COMMENT                         '#'
+#define CATALOG_SEPARATOR                       '|'
+#define CATALOG_FIELDS_COUNT                    4
 
 #define MESSAGE_QUIT                            'q'
+#define MESSAGE_ROUND_OVER                      '\0'
+#define MESSAGE_END_OF_INPUT                    -1
 #define MESSAGE_EMAIL                           '1'
-#define MESSAGE_EMAIL_TEXT                      " - Email notification is waiting.\n"
-#define MESSAGE_EMAIL_OUTCOME                   "[Outcome:] The TA announced: Everyone get 100 on the exercise!\n"
+#define MESSAGE_EMAIL_LABEL                     "Email notification"
+#define MESSAGE_EMAIL_TEXT                      "Email notification is waiting."
+#define MESSAGE_EMAIL_OUTCOME                   "The TA announced: Everyone get 100 on the exercise!"
 #define MESSAGE_DELIVERY                        '2'
-#define MESSAGE_DELIVERY_TEXT                   " - You have a reminder to pick up your delivery.\n"
-#define MESSAGE_DELIVERY_OUTCOME                "[Outcome:] You picked it up just in time.\n"
+#define MESSAGE_DELIVERY_LABEL                  "Reminder to pick up delivery"
+#define MESSAGE_DELIVERY_TEXT                   "You have a reminder to pick up your delivery."
+#define MESSAGE_DELIVERY_OUTCOME                "You picked it up just in time."
 #define MESSAGE_DOORBELL                        '3'
-#define MESSAGE_DOORBELL_TEXT                   " - The doorbell is ringing.\n"
-#define MESSAGE_DOORBELL_OUTCOME                "[Outcome:] Food delivery is here.\n"
+#define MESSAGE_DOORBELL_LABEL                  "Doorbell Ringing"
+#define MESSAGE_DOORBELL_TEXT                   "The doorbell is ringing."
+#define MESSAGE_DOORBELL_OUTCOME                "Food delivery is here."
+
+typedef struct
+{
+    char key;
+    char label[FOCUS_MAX_TEXT];
+    char text[FOCUS_MAX_TEXT];
+    char outcome[FOCUS_MAX_TEXT];
+} Distraction;
 
-typedef enum
+/*
+ * indexOf maps a key to its distraction, or to -1
+ */
+typedef struct
 {
-    false,
-    true
-} boolean;
-
-void SetSignalAction(int signal, void (*action)(int));
-char GetMessage();
-void PlayRound(int roundNumber, int duration);
-void ProcessSignals(const int* singals, int signalsCount);
-void ProcessSignalsV2(const int* singals, int signalsCount);
-void HandleFocusMode(int numOfRounds, int duration);
-void SendSignal(char message);
-int FindNewSignal(const int* seenSignals, int seenSignalsCount, const int* relevantSignals, int relevantSignalsCount);
-void ChangedBlockedSignals(int action, const int* signals, int signalsCount);
-
-void HandleFocusMode(int numOfRounds, int duration)
+    Distraction distractions[FOCUS_MAX_DISTRACTIONS];
+    int distractionsCount;
+    int indexOf[UCHAR_MAX + 1];
+} DistractionCatalog;
+
+/*
+ * What reached the user in a round: a bit per distraction which arrived, and how many times it did
+ */
+typedef struct
 {
+    uint32_t seen;
+    int counts[FOCUS_MAX_DISTRACTIONS];
+} RoundDistractions;
+
+/*
+ * A generator's counters, in memory shared with the focus process
+ */
+typedef struct
+{
+    long sentCount;
+    long droppedCount;
+} GeneratorStats;
+
+/*
+ * What the focus process received under load
+ */
+typedef struct
+{
+    long receivedCount;
+    long counts[FOCUS_MAX_DISTRACTIONS];
+    long latencies[LATENCY_BUCKETS_COUNT];
+    long long maxLatency;
+} LoadStats;
+
+/*
+ * The distraction signals stay blocked for the whole session and are received through signalFd, which epollFd
+ * watches together with stdin and, for timed rounds, the round's timerFd. stdin is read raw into input, and is not
+ * polled when epoll cannot watch it, e.g. a regular file, which is always readable.
+ */
+typedef struct
+{
+    const DistractionCatalog* catalog;
+    bool shouldShowCounts;
+    pid_t pid;
+    sigset_t signalsMask;
+    int epollFd;
+    int signalFd;
+    int timerFd;
+    bool isStdinPolled;
+    bool isStdinClosed;
+    char input[FOCUS_INPUT_SIZE];
+    ssize_t inputLength;
+    ssize_t inputPosition;
+} FocusSession;
+
+/*
+ * Where a round's distractions come from: the user, through GetMessage(), or a loaded script which is cycled
+ * through
+ */
+typedef struct MessageSource
+{
+    char (*NextMessage)(struct MessageSource* source);
+    FocusSession* session;
+    char* messages;
+    long messagesCount;
+    long next;
+    long messagesRead;
+} MessageSource;
+
+void LoadCatalog(const char* catalogPath, DistractionCatalog* ocatalog);
+void AddDistraction(DistractionCatalog* catalog, const char* fields[], int lineNumber);
+void BeginFocusSession(FocusSession* osession, const DistractionCatalog* catalog, FocusOptions options);
+void EndFocusSession(FocusSession* session);
+char GetMessage(FocusSession* session);
+bool WaitForInput(FocusSession* session);
+void SetRoundTimer(FocusSession* session, int seconds);
+void DrainSignals(FocusSession* session, RoundDistractions* round);
+char GetPromptedMessage(MessageSource* source);
+char GetScriptMessage(MessageSource* source);
+void LoadScript(const char* scriptPath, const DistractionCatalog* catalog, MessageSource* osource);
+void PlayRound(int roundNumber, int duration, MessageSource* source);
+void ProcessDistractions(const FocusSession* session, const RoundDistractions* round);
+void SendDistraction(FocusSession* session, char message, RoundDistractions* round);
+void ChangedBlockedSignals(int action, const sigset_t* signalsMask);
+long long GetTimeNs();
+void RunGenerator(int generatorIdx, pid_t focusPid, int distractionsCount, int rate, long long startingTime, long long endingTime, GeneratorStats* stats);
+void ReceiveLoad(int signalFd, LoadStats* stats);
+int GetLatencyBucket(long long latency);
+double GetLatencyPercentile(const LoadStats* stats, double percentile);
+
+static const Distraction defaultDistractions[] =
+{
+    { MESSAGE_EMAIL, MESSAGE_EMAIL_LABEL, MESSAGE_EMAIL_TEXT, MESSAGE_EMAIL_OUTCOME },
+    { MESSAGE_DELIVERY, MESSAGE_DELIVERY_LABEL, MESSAGE_DELIVERY_TEXT, MESSAGE_DELIVERY_OUTCOME },
+    { MESSAGE_DOORBELL, MESSAGE_DOORBELL_LABEL, MESSAGE_DOORBELL_TEXT, MESSAGE_DOORBELL_OUTCOME },
+};
+
+FocusOptions DefaultFocusOptions()
+{
+    FocusOptions options = { 0 };
+    options.loadRate = FOCUS_DEFAULT_LOAD_RATE;
+
+    return options;
+}
+
+/*
+ * Plays the rounds interactively, timed or from options.scriptPath. A script is replayed as fast as possible, and
+ * the replay rate goes to stderr.
+ */
+void HandleFocusMode(int numOfRounds, int duration, FocusOptions options)
+{
+    DistractionCatalog catalog;
+    FocusSession session;
+    MessageSource source = { 0 };
+    struct timespec startingTime;
+    struct timespec endingTime;
+
+    if (options.isTimed && (duration <= 0 || options.scriptPath != NULL))
+    {
+        fprintf(stderr, "Invalid argument error: timed rounds last at least a second and cannot be replayed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LoadCatalog(options.catalogPath, &catalog);
+    source.NextMessage = GetPromptedMessage;
+    source.session = &session;
+    if (options.scriptPath != NULL)
+    {
+        LoadScript(options.scriptPath, &catalog, &source);
+        if (setvbuf(stdout, NULL, _IOFBF, REPLAY_BUFFER_SIZE) != 0)
+        {
+            perror("setvbuf() error");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    BeginFocusSession(&session, &catalog, options);
+    clock_gettime(CLOCK_MONOTONIC, &startingTime);
     for (int i = 1; i <= numOfRounds; i++)
-        PlayRound(i, duration);
+        PlayRound(i, duration, &source);
+    EndFocusSession(&session);
 
     // for some reason it was printed this way in the example
     printf(NON_FIRST_ROUND_INTRO);
     printf(SESSION_OUTRO);
+
+    if (options.scriptPath != NULL)
+    {
+        fflush(stdout);
+        clock_gettime(CLOCK_MONOTONIC, &endingTime);
+
+        double elapsed = (double)(endingTime.tv_sec - startingTime.tv_sec) + (double)(endingTime.tv_nsec - startingTime.tv_nsec) / 1e9;
+        fprintf(stderr, REPLAY_REPORT, numOfRounds, source.messagesRead, elapsed, elapsed > 0 ? numOfRounds / elapsed : 0.0);
+        free(source.messages);
+    }
 }
 
-char GetMessage()
+/*
+ * Runs duration seconds of load. The generators are forked with the signals already blocked, so that none is
+ * delivered the default way before the signalfd receives it.
+ */
+void HandleFocusLoad(int generatorsCount, int duration, FocusOptions options)
 {
-    char messageType = -1;
+    DistractionCatalog catalog;
+    LoadStats* stats;
+    GeneratorStats* generators;
+    sigset_t signalsMask;
+    pid_t generatorPids[FOCUS_MAX_GENERATORS];
 
-    printf(GET_MESSAGE_PROMPT);
-    scanf(" %c", &messageType);
+    if (generatorsCount <= 0 || generatorsCount > FOCUS_MAX_GENERATORS || duration <= 0 || options.loadRate <= 0)
+    {
+        fprintf(stderr, "Invalid argument error: the load needs 1 to %d generators, a duration and a rate\n", FOCUS_MAX_GENERATORS);
+        exit(EXIT_FAILURE);
+    }
 
-    return messageType;
-}
+    LoadCatalog(options.catalogPath, &catalog);
+    sigemptyset(&signalsMask);
+    for (int i = 0; i < catalog.distractionsCount; i++)
+        sigaddset(&signalsMask, SIGRTMIN + i);
+    ChangedBlockedSignals(SIG_BLOCK, &signalsMask);
 
-void PlayRound(int roundNumber, int duration)
-{
-    const int relevantSignalsCount = 3;
-    const int relevantSignals[] = { SIGNAL_EMAIL, SIGNAL_DELIVERY, SIGNAL_DOORBELL };
+    int signalFd = signalfd(-1, &signalsMask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFd == -1)
+    {
+        perror("signalfd() error");
+        exit(EXIT_FAILURE);
+    }
 
-    int seenSignalsCount = 0;
-    int* seenSignals = (int*)malloc(relevantSignalsCount * sizeof(int));
-    if (seenSignals == NULL)
+    generators = mmap(NULL, generatorsCount * sizeof(GeneratorStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (generators == MAP_FAILED)
     {
-        perror("malloc() error");
+        perror("mmap() error");
+        exit(EXIT_FAILURE);
+    }
+    if ((stats = calloc(1, sizeof(LoadStats))) == NULL)
+    {
+        perror("calloc() error");
         exit(EXIT_FAILURE);
     }
 
-    printf(roundNumber == 1 ? FIRST_ROUND_INTRO : NON_FIRST_ROUND_INTRO);
-    printf(ADDITIONAL_ROUND_INTRO, roundNumber);
+    printf(LOAD_INTRO, generatorsCount, options.loadRate, duration);
+    fflush(stdout);
+
+    pid_t focusPid = getpid();
+    long long startingTime = GetTimeNs();
+    long long endingTime = startingTime + duration * NS_PER_SECOND;
+    for (int i = 0; i < generatorsCount; i++)
+    {
+        generatorPids[i] = fork();
+        if (generatorPids[i] == -1)
+        {
+            perror("fork() error");
+            exit(EXIT_FAILURE);
+        }
+        if (generatorPids[i] == 0)
+        {
+            RunGenerator(i, focusPid, catalog.distractionsCount, options.loadRate, startingTime, endingTime, &generators[i]);
+            _exit(EXIT_SUCCESS);
+        }
+    }
+
+    struct pollfd signalPoll = { .fd = signalFd, .events = POLLIN };
+    for (long long now = GetTimeNs(); now < endingTime; now = GetTimeNs())
+    {
+        if (poll(&signalPoll, 1, (endingTime - now) / 1000000 + 1) == -1 && errno != EINTR)
+        {
+            perror("poll() error");
+            exit(EXIT_FAILURE);
+        }
+        ReceiveLoad(signalFd, stats);
+    }
 
     /*
-     * BLOCK RELEVANT SIGNALS
+     * Whatever a generator sent was queued by the time it exited
      */
-    ChangedBlockedSignals(SIG_BLOCK, relevantSignals, relevantSignalsCount);
+    for (int i = 0; i < generatorsCount; i++)
+    {
+        int status;
+        if (waitpid(generatorPids[i], &status, 0) == -1)
+        {
+            perror("waitpid() error");
+            exit(EXIT_FAILURE);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            fprintf(stderr, "Focus-Load error: generator %d failed\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    ReceiveLoad(signalFd, stats);
+    double elapsed = (double)(GetTimeNs() - startingTime) / NS_PER_SECOND;
 
+    long sentCount = 0;
+    long droppedCount = 0;
+    for (int i = 0; i < generatorsCount; i++)
+    {
+        sentCount += generators[i].sentCount;
+        droppedCount += generators[i].droppedCount;
+    }
 
+    printf(LOAD_SENT, sentCount + droppedCount, droppedCount);
+    printf(LOAD_RECEIVED, stats->receivedCount, sentCount - stats->receivedCount);
+    printf(LOAD_THROUGHPUT, stats->receivedCount / elapsed);
+    printf(LOAD_LATENCY, GetLatencyPercentile(stats, 0.5), GetLatencyPercentile(stats, 0.9), GetLatencyPercentile(stats, 0.99),
+           GetLatencyPercentile(stats, 0.999), stats->maxLatency / 1e3);
+    if (options.shouldShowCounts)
+    {
+        for (int i = 0; i < catalog.distractionsCount; i++)
+            printf(LOAD_COUNT, catalog.distractions[i].label, stats->counts[i]);
+    }
 
+    free(stats);
+    munmap(generators, generatorsCount * sizeof(GeneratorStats));
+    close(signalFd);
+    ChangedBlockedSignals(SIG_UNBLOCK, &signalsMask);
+}
 
-    /*
-     * GENERATE seenSignals
-     */
-    for (int i = 0; i < duration; i++)
+/*
+ * Loads the built-in catalog when catalogPath is NULL. There are no more distractions than real-time signals.
+ */
+void LoadCatalog(const char* catalogPath, DistractionCatalog* ocatalog)
+{
+    ocatalog->distractionsCount = 0;
+    for (int i = 0; i <= UCHAR_MAX; i++)
+        ocatalog->indexOf[i] = -1;
+
+    if (catalogPath == NULL)
     {
-        int newSignal = -1;
+        for (size_t i = 0; i < sizeof(defaultDistractions) / sizeof(defaultDistractions[0]); i++)
+        {
+            const char key[] = { defaultDistractions[i].key, '\0' };
+            const char* fields[] = { key, defaultDistractions[i].label, defaultDistractions[i].text, defaultDistractions[i].outcome };
+            AddDistraction(ocatalog, fields, 0);
+        }
+        return;
+    }
 
+    FILE* catalogFile = fopen(catalogPath, "r");
+    if (catalogFile == NULL)
+    {
+        perror("fopen() error");
+        exit(EXIT_FAILURE);
+    }
 
+    char* line = NULL;
+    size_t lineLength = 0;
+    int lineNumber = 0;
+    while (getline(&line, &lineLength, catalogFile) > 0)
+    {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == CATALOG_COMMENT || line[0] == '\0')
+            continue;
+
+        const char* fields[CATALOG_FIELDS_COUNT] = { line };
+        int fieldsCount = 1;
+        for (char* c = line; *c != '\0'; c++)
+        {
+            if (*c != CATALOG_SEPARATOR)
+                continue;
+            if (fieldsCount == CATALOG_FIELDS_COUNT)
+            {
+                fieldsCount++;
+                break;
+            }
+            *c = '\0';
+            fields[fieldsCount++] = c + 1;
+        }
+        if (fieldsCount != CATALOG_FIELDS_COUNT)
+        {
+            fprintf(stderr, "Invalid argument error: line %d of the catalog is not <key>|<label>|<text>|<outcome>\n", lineNumber);
+            exit(EXIT_FAILURE);
+        }
+        AddDistraction(ocatalog, fields, lineNumber);
+    }
 
-        int message = GetMessage();
-        if (message == MESSAGE_QUIT)
-            break;
+    if (ferror(catalogFile))
+    {
+        perror("getline() error");
+        exit(EXIT_FAILURE);
+    }
+    free(line);
+    fclose(catalogFile);
 
+    if (ocatalog->distractionsCount == 0)
+    {
+        fprintf(stderr, "Invalid argument error: %s holds no distractions\n", catalogPath);
+        exit(EXIT_FAILURE);
+    }
+}
 
+void AddDistraction(DistractionCatalog* catalog, const char* fields[], int lineNumber)
+{
+    unsigned char key = fields[0][0];
 
-        SendSignal(message);
-        newSignal = FindNewSignal(seenSignals, seenSignalsCount, relevantSignals, relevantSignalsCount);
-        if (newSignal != -1)
+    if (catalog->distractionsCount == FOCUS_MAX_DISTRACTIONS || catalog->distractionsCount > SIGRTMAX - SIGRTMIN)
+    {
+        fprintf(stderr, "Invalid argument error: line %d of the catalog is one distraction too many\n", lineNumber);
+        exit(EXIT_FAILURE);
+    }
+    if (fields[0][1] != '\0' || isspace(key) || key == MESSAGE_QUIT || catalog->indexOf[key] != -1)
+    {
+        fprintf(stderr, "Invalid argument error: line %d of the catalog needs a key of its own\n", lineNumber);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 1; i < CATALOG_FIELDS_COUNT; i++)
+    {
+        if (strlen(fields[i]) >= FOCUS_MAX_TEXT)
         {
-            seenSignals[seenSignalsCount] = newSignal;
-            seenSignalsCount++;
+            fprintf(stderr, "Invalid argument error: line %d of the catalog is too long\n", lineNumber);
+            exit(EXIT_FAILURE);
         }
     }
 
+    Distraction* distraction = &catalog->distractions[catalog->distractionsCount];
+    distraction->key = key;
+    strcpy(distraction->label, fields[1]);
+    strcpy(distraction->text, fields[2]);
+    strcpy(distraction->outcome, fields[3]);
+    catalog->indexOf[key] = catalog->distractionsCount++;
+}
 
+/*
+ * Reads the whole script at once, keeping every message character. Lines starting with '#' are comments.
+ */
+void LoadScript(const char* scriptPath, const DistractionCatalog* catalog, MessageSource* osource)
+{
+    FILE* script = fopen(scriptPath, "r");
+    if (script == NULL)
+    {
+        perror("fopen() error");
+        exit(EXIT_FAILURE);
+    }
 
-    /*
-     * PROCESSING THE SIGNALS WHICH WERE SENT
-     */
-    printf(DISTRACTIONS_INTRO);
-    if (seenSignalsCount == 0)
-        printf(DISTRACTIONS_INTRO_EMPTY);
+    char* line = NULL;
+    size_t lineLength = 0;
+    long capacity = 0;
+    while (getline(&line, &lineLength, script) > 0)
+    {
+        if (line[0] == REPLAY_COMMENT)
+            continue;
 
-    ProcessSignalsV2(seenSignals, seenSignalsCount);
+        for (char* c = line; *c != '\0'; c++)
+        {
+            if (isspace((unsigned char)*c))
+                continue;
+            if (*c != MESSAGE_QUIT && catalog->indexOf[(unsigned char)*c] == -1)
+            {
+                fprintf(stderr, "Invalid argument error: '%c' is invalid\n", *c);
+                exit(EXIT_FAILURE);
+            }
 
+            if (osource->messagesCount == capacity)
+            {
+                capacity = capacity == 0 ? 64 : 2 * capacity;
+                char* messages = realloc(osource->messages, capacity);
+                if (messages == NULL)
+                {
+                    perror("realloc() error");
+                    exit(EXIT_FAILURE);
+                }
+                osource->messages = messages;
+            }
+            osource->messages[osource->messagesCount++] = *c;
+        }
+    }
 
+    if (ferror(script))
+    {
+        perror("getline() error");
+        exit(EXIT_FAILURE);
+    }
+    free(line);
+    fclose(script);
 
-    /*
-     * CLEANUP PENDING SIGNALS
-     */
+    if (osource->messagesCount == 0)
+    {
+        fprintf(stderr, "Invalid argument error: %s holds no distractions\n", scriptPath);
+        exit(EXIT_FAILURE);
+    }
+    osource->NextMessage = GetScriptMessage;
+}
 
+char GetPromptedMessage(MessageSource* source)
+{
+    source->messagesRead++;
 
+    return GetMessage(source->session);
+}
 
-    /*
-     * SET SIGNAL ACTION TO IGNORE
-     */
-    for (int i = 0; i < seenSignalsCount; i++)
-        SetSignalAction(seenSignals[i], SIG_IGN);
+char GetScriptMessage(MessageSource* source)
+{
+    char message = source->messages[source->next];
 
+    source->messagesRead++;
+    source->next = (source->next + 1) % source->messagesCount;
 
+    return message;
+}
+
+/*
+ * Blocks the catalog's signals once for the whole session, so that they queue on the signalfd
+ */
+void BeginFocusSession(FocusSession* osession, const DistractionCatalog* catalog, FocusOptions options)
+{
+    struct epoll_event event = { 0 };
+
+    osession->catalog = catalog;
+    osession->shouldShowCounts = options.shouldShowCounts;
+    osession->pid = getpid();
+    osession->timerFd = -1;
+    osession->isStdinPolled = true;
+    osession->isStdinClosed = false;
+    osession->inputLength = 0;
+    osession->inputPosition = 0;
+
+    sigemptyset(&osession->signalsMask);
+    for (int i = 0; i < catalog->distractionsCount; i++)
+        sigaddset(&osession->signalsMask, SIGRTMIN + i);
+    ChangedBlockedSignals(SIG_BLOCK, &osession->signalsMask);
+
+    if ((osession->signalFd = signalfd(-1, &osession->signalsMask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1)
+    {
+        perror("signalfd() error");
+        exit(EXIT_FAILURE);
+    }
+    if ((osession->epollFd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    {
+        perror("epoll_create1() error");
+        exit(EXIT_FAILURE);
+    }
 
     /*
-     * UNBLOCK SIGNALS
+     * Edge triggered: the queued signals are left for the end of the round, so they must not keep waking the loop
      */
-    ChangedBlockedSignals(SIG_UNBLOCK, relevantSignals, relevantSignalsCount);
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = osession->signalFd;
+    if (epoll_ctl(osession->epollFd, EPOLL_CTL_ADD, osession->signalFd, &event) == -1)
+    {
+        perror("epoll_ctl() error");
+        exit(EXIT_FAILURE);
+    }
 
+    event.events = EPOLLIN;
+    event.data.fd = STDIN_FILENO;
+    if (epoll_ctl(osession->epollFd, EPOLL_CTL_ADD, STDIN_FILENO, &event) == -1)
+    {
+        if (errno != EPERM)
+        {
+            perror("epoll_ctl() error");
+            exit(EXIT_FAILURE);
+        }
+        osession->isStdinPolled = false;
+    }
 
+    if (!options.isTimed)
+        return;
 
-    /*
-     * SET SIGNAL ACTION TO DEFAULT
-     */
-    for (int i = 0; i < seenSignalsCount; i++)
-        SetSignalAction(seenSignals[i], SIG_DFL);
+    if ((osession->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1)
+    {
+        perror("timerfd_create() error");
+        exit(EXIT_FAILURE);
+    }
+    event.events = EPOLLIN;
+    event.data.fd = osession->timerFd;
+    if (epoll_ctl(osession->epollFd, EPOLL_CTL_ADD, osession->timerFd, &event) == -1)
+    {
+        perror("epoll_ctl() error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * Every round drained its signals, so unblocking them delivers nothing
+ */
+void EndFocusSession(FocusSession* session)
+{
+    if (session->timerFd != -1)
+        close(session->timerFd);
+    close(session->epollFd);
+    close(session->signalFd);
 
+    ChangedBlockedSignals(SIG_UNBLOCK, &session->signalsMask);
+}
 
+/*
+ * Returns the next non blank character of stdin, MESSAGE_ROUND_OVER once a timed round's time is up, or
+ * MESSAGE_END_OF_INPUT if stdin was closed and the round is not timed
+ */
+char GetMessage(FocusSession* session)
+{
+    const DistractionCatalog* catalog = session->catalog;
 
-    free(seenSignals);
+    printf(GET_MESSAGE_PROMPT);
+    for (int i = 0; i < catalog->distractionsCount; i++)
+        printf(GET_MESSAGE_PROMPT_ENTRY, catalog->distractions[i].key, catalog->distractions[i].label);
+    printf(GET_MESSAGE_PROMPT_QUIT);
+    fflush(stdout);
+
+    while (true)
+    {
+        while (session->inputPosition < session->inputLength)
+        {
+            char c = session->input[session->inputPosition++];
+            if (!isspace((unsigned char)c))
+                return c;
+        }
+
+        if (session->isStdinClosed && session->timerFd == -1)
+            return MESSAGE_END_OF_INPUT;
+        if (!WaitForInput(session))
+        {
+            printf(ROUND_TIME_UP);
+            return MESSAGE_ROUND_OVER;
+        }
+    }
 }
 
 /*
- * For some reason it seems like we're not supposed to process the sign als in the order that they were received.
+ * Refills the input buffer, returning false if the round's time ran out first. Once stdin is closed, only waits
+ * for the time to run out.
  */
-void ProcessSignals(const int* signals, int signalsCount)
+bool WaitForInput(FocusSession* session)
 {
-    for (int i = 0; i < signalsCount; i++)
+    struct epoll_event events[FOCUS_EVENTS_COUNT];
+
+    while (true)
     {
-        char* messageText = NULL;
-        char* messageOutcome = NULL;
+        bool isStdinReady = !session->isStdinPolled && !session->isStdinClosed;
 
-        switch (signals[i])
+        if (!isStdinReady)
         {
-            case SIGNAL_EMAIL:
-                messageText = MESSAGE_EMAIL_TEXT;
-                messageOutcome = MESSAGE_EMAIL_OUTCOME;
-                break;
-            case SIGNAL_DELIVERY:
-                messageText = MESSAGE_DELIVERY_TEXT;
-                messageOutcome = MESSAGE_DELIVERY_OUTCOME;
-                break;
-            case SIGNAL_DOORBELL:
-                messageText = MESSAGE_DOORBELL_TEXT;
-                messageOutcome = MESSAGE_DOORBELL_OUTCOME;
-                break;
-            default:
-                fprintf(stderr, "Invalid argument error: '%d' is an invalid signal number\n", signals[i]);
-                break;
+            int eventsCount = epoll_wait(session->epollFd, events, FOCUS_EVENTS_COUNT, -1);
+            if (eventsCount == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                perror("epoll_wait() error");
+                exit(EXIT_FAILURE);
+            }
+
+            for (int i = 0; i < eventsCount; i++)
+            {
+                if (events[i].data.fd == session->timerFd)
+                    return false;
+                if (events[i].data.fd == STDIN_FILENO)
+                    isStdinReady = true;
+            }
+            if (!isStdinReady)
+                continue;
+        }
+
+        ssize_t length = read(STDIN_FILENO, session->input, FOCUS_INPUT_SIZE);
+        if (length == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            perror("read() error");
+            exit(EXIT_FAILURE);
+        }
+        if (length == 0)
+        {
+            session->isStdinClosed = true;
+            if (session->isStdinPolled)
+                epoll_ctl(session->epollFd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+            return true;
         }
 
-        printf("%s", messageText);
-        printf("%s", messageOutcome);
+        session->inputLength = length;
+        session->inputPosition = 0;
+        return true;
     }
 }
 
 /*
- * For some reason it seems like we're not supposed to process the sign als in the order that they were received.
+ * Arms the round's timer, or disarms it for 0 seconds. Setting a timerfd also clears its pending expirations.
  */
-void ProcessSignalsV2(const int* signals, int signalsCount)
+void SetRoundTimer(FocusSession* session, int seconds)
 {
-    boolean seenEmail = false;
-    boolean seenDelivery = false;
-    boolean seenDoorbell = false;
+    struct itimerspec timer = { 0 };
+    timer.it_value.tv_sec = seconds;
 
-    for (int i = 0; i < signalsCount; i++)
+    if (timerfd_settime(session->timerFd, 0, &timer, NULL) == -1)
     {
-        switch (signals[i])
+        perror("timerfd_settime() error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * Adds every signal queued so far to the round, whoever sent it
+ */
+void DrainSignals(FocusSession* session, RoundDistractions* round)
+{
+    struct signalfd_siginfo infos[FOCUS_SIGNALS_BATCH];
+
+    while (true)
+    {
+        ssize_t length = read(session->signalFd, infos, sizeof(infos));
+        if (length == -1)
         {
-            case SIGNAL_EMAIL:
-                seenEmail = true;
-                break;
-            case SIGNAL_DELIVERY:
-                seenDelivery = true;
-                break;
-            case SIGNAL_DOORBELL:
-                seenDoorbell = true;
-                break;
-            default:
-                fprintf(stderr, "Invalid argument error: '%d' is an invalid signal number\n", signals[i]);
+            if (errno == EAGAIN)
                 break;
+            if (errno == EINTR)
+                continue;
+            perror("read() error");
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t i = 0; i < length / sizeof(struct signalfd_siginfo); i++)
+        {
+            int index = (int)infos[i].ssi_signo - SIGRTMIN;
+            round->seen |= (uint32_t)1 << index;
+            round->counts[index]++;
         }
     }
-    if (seenEmail)
-        printf("%s%s", MESSAGE_EMAIL_TEXT, MESSAGE_EMAIL_OUTCOME);
-    if (seenDelivery)
-        printf("%s%s", MESSAGE_DELIVERY_TEXT, MESSAGE_DELIVERY_OUTCOME);
-    if (seenDoorbell)
-        printf("%s%s", MESSAGE_DOORBELL_TEXT, MESSAGE_DOORBELL_OUTCOME);
 }
 
-void SendSignal(char message)
+/*
+ * Sent distractions queue on the session's signalfd, and are drained every FOCUS_SIGNALS_BATCH of them: the
+ * kernel hands out the lowest real-time signal first, walking the queue past the others, so a deep queue of mixed
+ * distractions would drain in quadratic time. A timed round ignores duration as a count and ends once its time
+ * is up.
+ */
+void PlayRound(int roundNumber, int duration, MessageSource* source)
 {
-    int signalNumber = -1;
-    switch (message)
+    FocusSession* session = source->session;
+    RoundDistractions round = { 0 };
+    bool isTimed = session->timerFd != -1;
+
+    printf(roundNumber == 1 ? FIRST_ROUND_INTRO : NON_FIRST_ROUND_INTRO);
+    printf(ADDITIONAL_ROUND_INTRO, roundNumber);
+
+    if (isTimed)
+        SetRoundTimer(session, duration);
+
+
+
+    /*
+     * SEND THE DISTRACTIONS
+     */
+    for (int i = 0; isTimed || i < duration; i++)
     {
-        case MESSAGE_EMAIL:
-            signalNumber = SIGNAL_EMAIL;
-            break;
-        case MESSAGE_DELIVERY:
-            signalNumber = SIGNAL_DELIVERY;
-            break;
-        case MESSAGE_DOORBELL:
-            signalNumber = SIGNAL_DOORBELL;
-            break;
-        default:
+        int message = source->NextMessage(source);
+        if (message == MESSAGE_QUIT || message == MESSAGE_ROUND_OVER)
             break;
+
+        SendDistraction(session, message, &round);
+        if ((i + 1) % FOCUS_SIGNALS_BATCH == 0)
+            DrainSignals(session, &round);
+    }
+
+    if (isTimed)
+        SetRoundTimer(session, 0);
+
+
+
+    /*
+     * PROCESSING THE SIGNALS WHICH WERE SENT
+     */
+    DrainSignals(session, &round);
+
+    printf(DISTRACTIONS_INTRO);
+    if (round.seen == 0)
+        printf(DISTRACTIONS_INTRO_EMPTY);
+
+    ProcessDistractions(session, &round);
+}
+
+/*
+ * For some reason it seems like we're not supposed to process the sign als in the order that they were received.
+ * They are processed in the catalog's order instead.
+ */
+void ProcessDistractions(const FocusSession* session, const RoundDistractions* round)
+{
+    for (uint32_t seen = round->seen; seen != 0; seen &= seen - 1)
+    {
+        int index = __builtin_ctz(seen);
+        const Distraction* distraction = &session->catalog->distractions[index];
+
+        printf(DISTRACTION_TEXT, distraction->text);
+        printf(DISTRACTION_OUTCOME, distraction->outcome);
+        if (session->shouldShowCounts)
+            printf(DISTRACTION_COUNT, round->counts[index]);
     }
+}
 
-    if (signalNumber == -1)
+/*
+ * Queues the message's distraction, its catalog index as the payload. A full signal queue is drained into the
+ * round to make room.
+ */
+void SendDistraction(FocusSession* session, char message, RoundDistractions* round)
+{
+    int index = session->catalog->indexOf[(unsigned char)message];
+    if (index == -1)
     {
         fprintf(stderr, "Invalid argument error: '%c' is invalid\n", message);
         exit(EXIT_FAILURE);
     }
 
-    if (raise(signalNumber) != 0)
+    union sigval value;
+    value.sival_int = index;
+    while (sigqueue(session->pid, SIGRTMIN + index, value) != 0)
     {
-        perror("raise() error");
-        exit(EXIT_FAILURE);
+        if (errno != EAGAIN)
+        {
+            perror("sigqueue() error");
+            exit(EXIT_FAILURE);
+        }
+        DrainSignals(session, round);
     }
 }
 
-int FindNewSignal(const int* seenSignals, int seenSignalsCount, const int* relevantSignals, int relevantSignalsCount)
+void ChangedBlockedSignals(int action, const sigset_t* signalsMask)
 {
-    sigset_t pendingSignals;
-    if (sigpending(&pendingSignals) != 0)
+    if (sigprocmask(action, signalsMask, NULL) == -1)
     {
-        perror("sigpending() error");
+        perror("sigprocmask() error");
         exit(EXIT_FAILURE);
     }
+}
+
+long long GetTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * NS_PER_SECOND + now.tv_nsec;
+}
+
+/*
+ * Sends the signals due by now in one burst, then sleeps until the next one is due, so that high rates do not cost
+ * a sleep per signal. Generators start on different distractions and cycle through the catalog.
+ */
+void RunGenerator(int generatorIdx, pid_t focusPid, int distractionsCount, int rate, long long startingTime, long long endingTime, GeneratorStats* stats)
+{
+    long attemptsCount = 0;
 
-    for (int i = 0; i < relevantSignalsCount; i++)
+    for (long long now = GetTimeNs(); now < endingTime; now = GetTimeNs())
     {
-        if (sigismember(&pendingSignals, relevantSignals[i]))
+        long dueCount = (long)((double)(now - startingTime) * rate / NS_PER_SECOND) + 1;
+        for (; attemptsCount < dueCount; attemptsCount++)
         {
-            boolean isSignalSeen = false;
-            for (int j = 0; j < seenSignalsCount; j++)
+            union sigval value;
+            value.sival_ptr = (void*)(uintptr_t)GetTimeNs();
+
+            if (sigqueue(focusPid, SIGRTMIN + (generatorIdx + attemptsCount) % distractionsCount, value) == 0)
+                stats->sentCount++;
+            else if (errno == EAGAIN)
+                stats->droppedCount++;
+            else
             {
-                if (relevantSignals[i] == seenSignals[j])
-                    isSignalSeen = true;
+                perror("sigqueue() error");
+                _exit(EXIT_FAILURE);
             }
-            if (!isSignalSeen)
-                return relevantSignals[i];
         }
-    }
 
-    return -1;
+        long long nextTime = startingTime + (long long)((double)attemptsCount * NS_PER_SECOND / rate);
+        if (nextTime > endingTime)
+            nextTime = endingTime;
+        struct timespec wakeUp = { .tv_sec = nextTime / NS_PER_SECOND, .tv_nsec = nextTime % NS_PER_SECOND };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeUp, NULL);
+    }
 }
 
-void ChangedBlockedSignals(int action, const int* signals, int signalsCount)
+/*
+ * Reads every queued signal, timing a batch's signals against a single receipt time
+ */
+void ReceiveLoad(int signalFd, LoadStats* stats)
 {
-    sigset_t signalsMask;
-    sigemptyset(&signalsMask);
-
-    for (int i = 0; i < signalsCount; i++)
-        sigaddset(&signalsMask, signals[i]);
+    struct signalfd_siginfo infos[FOCUS_SIGNALS_BATCH];
 
-    if (sigprocmask(action, &signalsMask, NULL) == -1)
+    while (true)
     {
-        perror("sigprocmask() error");
-        exit(EXIT_FAILURE);
+        ssize_t length = read(signalFd, infos, sizeof(infos));
+        if (length == -1)
+        {
+            if (errno == EAGAIN)
+                break;
+            if (errno == EINTR)
+                continue;
+            perror("read() error");
+            exit(EXIT_FAILURE);
+        }
+
+        long long now = GetTimeNs();
+        for (size_t i = 0; i < length / sizeof(struct signalfd_siginfo); i++)
+        {
+            long long latency = now - (long long)infos[i].ssi_ptr;
+            if (latency < 0)
+                latency = 0;
+
+            stats->receivedCount++;
+            stats->counts[infos[i].ssi_signo - SIGRTMIN]++;
+            stats->latencies[GetLatencyBucket(latency)]++;
+            if (latency > stats->maxLatency)
+                stats->maxLatency = latency;
+        }
     }
 }
 
-void SetSignalAction(int signal, void (*action)(int))
+/*
+ * Latencies below LATENCY_SUB_BUCKETS get a bucket each, larger ones LATENCY_SUB_BUCKETS buckets per power of two
+ */
+int GetLatencyBucket(long long latency)
 {
-        struct sigaction act;
-        sigemptyset(&act.sa_mask);
-        act.sa_flags = 0;
-        act.sa_handler = SIG_IGN;
+    if (latency < LATENCY_SUB_BUCKETS)
+        return latency;
 
-        if (sigaction(signal, &act, NULL) != 0)
-        {
-            perror("sigaction() error");
-            exit(EXIT_FAILURE);
-        }
+    int exponent = 63 - __builtin_clzll(latency);
+    int subBucket = (latency >> (exponent - LATENCY_SUB_BUCKETS_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+
+    return (exponent - LATENCY_SUB_BUCKETS_BITS + 1) * LATENCY_SUB_BUCKETS + subBucket;
+}
+
+/*
+ * In microseconds, the lower bound of the bucket holding the percentile
+ */
+double GetLatencyPercentile(const LoadStats* stats, double percentile)
+{
+    long rank = (long)(percentile * stats->receivedCount);
+    long seenCount = 0;
+
+    for (int i = 0; i < LATENCY_BUCKETS_COUNT; i++)
+    {
+        seenCount += stats->latencies[i];
+        if (seenCount <= rank)
+            continue;
+        if (i < LATENCY_SUB_BUCKETS)
+            return i / 1e3;
+
+        int exponent = i / LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS_BITS - 1;
+        long long subBucket = i % LATENCY_SUB_BUCKETS;
+        return ((LATENCY_SUB_BUCKETS + subBucket) << (exponent - LATENCY_SUB_BUCKETS_BITS)) / 1e3;
+    }
+
+    return 0.0;
 }
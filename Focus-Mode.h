@@ -0,0 +1,40 @@
+#ifndef FOCUS_MODE_H
+#define FOCUS_MODE_H
+
+#include <stdbool.h>
+
+/*
+ * Distractions come from a catalog: the built-in one holds the email, the delivery and the doorbell, and
+ * FocusOptions.catalogPath replaces it with a file holding a distraction per line:
+ *   <key>|<label>|<text>|<outcome>
+ * <key> being the character which sends it and <label> how the prompt lists it. Lines starting with '#' are
+ * comments. The n-th distraction is sent as the real-time signal SIGRTMIN+n, so that repeats queue rather than
+ * collapse, and shouldShowCounts reports how many times each one arrived in the round.
+ */
+#define FOCUS_MAX_DISTRACTIONS 32
+#define FOCUS_MAX_TEXT 128
+
+/*
+ * Load mode: forks generator processes which send the catalog's distractions to the focus process at loadRate
+ * signals per second each, a sender timestamp as the payload. The focus process keeps the signals blocked,
+ * receives them through a signalfd, and reports the delivery latency percentiles, the throughput, and how many
+ * signals were dropped because the queue was full or coalesced on the way.
+ */
+#define FOCUS_MAX_GENERATORS 64
+#define FOCUS_DEFAULT_LOAD_RATE 1000
+
+typedef struct
+{
+    const char* scriptPath;
+    const char* catalogPath;
+    bool isTimed;
+    bool shouldShowCounts;
+    int loadRate;
+} FocusOptions;
+
+
+FocusOptions DefaultFocusOptions();
+void HandleFocusMode(int numOfRounds, int duration, FocusOptions options);
+void HandleFocusLoad(int generatorsCount, int duration, FocusOptions options);
+
+#endif
@@ -0,0 +1,244 @@
+#include <string.h>
+
+#include "Group-Queue.h"
+
+
+int GetProcessGroup(GroupQueue* queue, const Process* proc);
+bool IsQueuedBefore(GroupQueue* queue, int a, int b);
+int MergeNodes(GroupQueue* queue, int a, int b);
+int GetNodeRank(const GroupQueue* queue, int node);
+bool IsGroupPickedBefore(const GroupQueue* queue, int a, int b);
+void SiftGroupUp(GroupQueue* queue, int i);
+void SiftGroupDown(GroupQueue* queue, int i);
+
+
+
+bool WorkloadHasGroups(const Process procs[], int procsCount)
+{
+    for (int i = 0; i < procsCount; i++)
+        if (procs[i].group[0] != '\0')
+            return true;
+
+    return false;
+}
+
+void GroupQueueInit(GroupQueue* queue, int (*CmpPriority)(Process, Process), int maxUptime, SchedulerCounters* counters)
+{
+    queue->CmpPriority = CmpPriority;
+    queue->maxUptime = maxUptime;
+    queue->counters = counters;
+    queue->seq = 0;
+    queue->minVruntime = 0;
+    queue->groupsCount = 0;
+    queue->runnableCount = 0;
+    for (int i = 0; i < GROUP_TABLE_SIZE; i++)
+        queue->table[i] = GROUP_NIL;
+    for (int i = 0; i < MAX_PROC; i++)
+        queue->groupOf[i] = GROUP_NIL;
+}
+
+/*
+ * Every process is queued at most once, so its node is free
+ */
+void GroupQueueEnqueue(GroupQueue* queue, Process item)
+{
+    int idx = item.original_idx;
+    if (queue->groupOf[idx] == GROUP_NIL)
+        queue->groupOf[idx] = GetProcessGroup(queue, &item);
+    ProcessGroup* group = &queue->groups[queue->groupOf[idx]];
+
+    GroupQueueNode* node = &queue->nodes[idx];
+    node->proc = item;
+    node->seq = queue->seq++;
+    node->left = GROUP_NIL;
+    node->right = GROUP_NIL;
+    node->rank = 1;
+
+    if (group->size == 0)
+    {
+        if (group->vruntime < queue->minVruntime)
+            group->vruntime = queue->minVruntime;
+        queue->runnable[queue->runnableCount++] = queue->groupOf[idx];
+        SiftGroupUp(queue, queue->runnableCount - 1);
+    }
+    group->root = MergeNodes(queue, group->root, idx);
+    group->size++;
+}
+
+/*
+ * Picks the first process of the group with the least virtual runtime, and charges the group for the time the
+ * process will keep the CPU. The queue must not be empty.
+ */
+Process GroupQueueDequeue(GroupQueue* queue)
+{
+    ProcessGroup* group = &queue->groups[queue->runnable[0]];
+    GroupQueueNode* node = &queue->nodes[group->root];
+    Process proc = node->proc;
+
+    group->root = MergeNodes(queue, node->left, node->right);
+    group->size--;
+
+    int runLength = queue->maxUptime != -1 && queue->maxUptime < proc.burst_time ? queue->maxUptime : proc.burst_time;
+    queue->minVruntime = group->vruntime;
+    group->vruntime += runLength * GROUP_VRUNTIME_SCALE / group->weight;
+
+    if (group->size == 0)
+        queue->runnable[0] = queue->runnable[--queue->runnableCount];
+    SiftGroupDown(queue, 0);
+
+    return proc;
+}
+
+/*
+ * Adds a run's waiting time to the process' group, finishTime being when the process completed or -1
+ */
+void GroupQueueAccount(GroupQueue* queue, int processIdx, int waitingTime, int finishTime)
+{
+    ProcessGroup* group = &queue->groups[queue->groupOf[processIdx]];
+
+    group->totalWaitingTime += waitingTime;
+    if (finishTime != -1)
+        group->turnaroundTime = finishTime;
+}
+
+/*
+ * Fills ogroups, in the order the groups were first queued, and returns how many there are
+ */
+int GroupQueueGetMetrics(const GroupQueue* queue, SchedulerGroupMetrics ogroups[])
+{
+    for (int i = 0; i < queue->groupsCount; i++)
+    {
+        const ProcessGroup* group = &queue->groups[i];
+        strcpy(ogroups[i].name, group->name);
+        ogroups[i].weight = group->weight;
+        ogroups[i].processesCount = group->processesCount;
+        ogroups[i].totalWaitingTime = group->totalWaitingTime;
+        ogroups[i].averageWaitingTime = group->processesCount > 0 ? (double)group->totalWaitingTime / group->processesCount : 0.0;
+        ogroups[i].turnaroundTime = group->turnaroundTime;
+    }
+
+    return queue->groupsCount;
+}
+
+
+
+/*
+ * Finds the process' group by name, creating it the first time. A group's weight is the largest any of its
+ * processes gives.
+ */
+int GetProcessGroup(GroupQueue* queue, const Process* proc)
+{
+    unsigned hash = 2166136261u;
+    for (const char* c = proc->group; *c != '\0'; c++)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+
+    unsigned slot = hash % GROUP_TABLE_SIZE;
+    while (queue->table[slot] != GROUP_NIL && strcmp(queue->groups[queue->table[slot]].name, proc->group) != 0)
+        slot = (slot + 1) % GROUP_TABLE_SIZE;
+
+    if (queue->table[slot] == GROUP_NIL)
+    {
+        ProcessGroup* group = &queue->groups[queue->groupsCount];
+        memset(group, 0, sizeof(ProcessGroup));
+        strcpy(group->name, proc->group);
+        group->weight = 1;
+        group->vruntime = queue->minVruntime;
+        group->root = GROUP_NIL;
+        queue->table[slot] = queue->groupsCount++;
+    }
+
+    ProcessGroup* group = &queue->groups[queue->table[slot]];
+    if (proc->groupWeight > group->weight)
+        group->weight = proc->groupWeight;
+    group->processesCount++;
+
+    return queue->table[slot];
+}
+
+bool IsQueuedBefore(GroupQueue* queue, int a, int b)
+{
+    int cmpRes = queue->CmpPriority(queue->nodes[a].proc, queue->nodes[b].proc);
+    if (queue->counters != NULL)
+        queue->counters->comparatorCalls++;
+    if (cmpRes != 0)
+        return cmpRes < 0;
+
+    return queue->nodes[a].seq < queue->nodes[b].seq;
+}
+
+/*
+ * Leftist heap merge: walks down the right spines, which are O(log n) long, keeping the shorter spine on the right
+ */
+int MergeNodes(GroupQueue* queue, int a, int b)
+{
+    if (a == GROUP_NIL)
+        return b;
+    if (b == GROUP_NIL)
+        return a;
+
+    if (IsQueuedBefore(queue, b, a))
+    {
+        int temp = a;
+        a = b;
+        b = temp;
+    }
+
+    GroupQueueNode* node = &queue->nodes[a];
+    node->right = MergeNodes(queue, node->right, b);
+    if (GetNodeRank(queue, node->left) < GetNodeRank(queue, node->right))
+    {
+        int temp = node->left;
+        node->left = node->right;
+        node->right = temp;
+    }
+    node->rank = GetNodeRank(queue, node->right) + 1;
+
+    return a;
+}
+
+int GetNodeRank(const GroupQueue* queue, int node)
+{
+    return node == GROUP_NIL ? 0 : queue->nodes[node].rank;
+}
+
+/*
+ * Groups with equal virtual runtimes are picked in the order they were first queued
+ */
+bool IsGroupPickedBefore(const GroupQueue* queue, int a, int b)
+{
+    if (queue->groups[a].vruntime != queue->groups[b].vruntime)
+        return queue->groups[a].vruntime < queue->groups[b].vruntime;
+
+    return a < b;
+}
+
+void SiftGroupUp(GroupQueue* queue, int i)
+{
+    int group = queue->runnable[i];
+
+    while (i > 0 && IsGroupPickedBefore(queue, group, queue->runnable[(i - 1) / 2]))
+    {
+        queue->runnable[i] = queue->runnable[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    queue->runnable[i] = group;
+}
+
+void SiftGroupDown(GroupQueue* queue, int i)
+{
+    if (i >= queue->runnableCount)
+        return;
+
+    int group = queue->runnable[i];
+    while (2 * i + 1 < queue->runnableCount)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < queue->runnableCount && IsGroupPickedBefore(queue, queue->runnable[child + 1], queue->runnable[child]))
+            child++;
+        if (!IsGroupPickedBefore(queue, queue->runnable[child], group))
+            break;
+        queue->runnable[i] = queue->runnable[child];
+        i = child;
+    }
+    queue->runnable[i] = group;
+}
@@ -0,0 +1,70 @@
+#ifndef GROUP_QUEUE_H
+#define GROUP_QUEUE_H
+
+#include <stdbool.h>
+
+#include "CPU-Scheduler.h"
+
+/*
+ * Two level ready queue for workloads with process groups.
+ *
+ * The top level picks the runnable group with the least virtual runtime, a group being charged every run of its
+ * processes divided by its weight, so that groups share the CPU in proportion to their weights. A group becoming
+ * runnable again starts no lower than the group picked last, and cannot claim the time it spent idle. The bottom
+ * level orders every group's processes by the policy's comparator, then by the order they were queued in, which
+ * is the order the flat ReadyQueue keeps.
+ *
+ * Runnable groups are a binary min-heap and every group's processes a leftist heap whose nodes belong to the
+ * processes themselves (a process is queued at most once), so queueing and picking are O(log n) without
+ * allocating.
+ */
+#define GROUP_TABLE_SIZE (2 * MAX_GROUPS)
+#define GROUP_VRUNTIME_SCALE 1000000LL
+#define GROUP_NIL -1
+
+typedef struct
+{
+    Process proc;
+    long seq;
+    int left;
+    int right;
+    int rank;
+} GroupQueueNode;
+
+typedef struct
+{
+    char name[MAX_NAME];
+    int weight;
+    long long vruntime;
+    int root;
+    int size;
+    int processesCount;
+    int totalWaitingTime;
+    int turnaroundTime;
+} ProcessGroup;
+
+typedef struct
+{
+    int (*CmpPriority)(Process, Process);
+    int maxUptime;
+    SchedulerCounters* counters;
+    long seq;
+    long long minVruntime;
+    int groupsCount;
+    int runnableCount;
+    ProcessGroup groups[MAX_GROUPS];
+    int runnable[MAX_GROUPS];
+    int table[GROUP_TABLE_SIZE];
+    int groupOf[MAX_PROC];
+    GroupQueueNode nodes[MAX_PROC];
+} GroupQueue;
+
+
+bool WorkloadHasGroups(const Process procs[], int procsCount);
+void GroupQueueInit(GroupQueue* queue, int (*CmpPriority)(Process, Process), int maxUptime, SchedulerCounters* counters);
+void GroupQueueEnqueue(GroupQueue* queue, Process item);
+Process GroupQueueDequeue(GroupQueue* queue);
+void GroupQueueAccount(GroupQueue* queue, int processIdx, int waitingTime, int finishTime);
+int GroupQueueGetMetrics(const GroupQueue* queue, SchedulerGroupMetrics ogroups[]);
+
+#endif
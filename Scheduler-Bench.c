@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "CPU-Scheduler.h"
+
+/*
+ * Throughput benchmark of the scheduling engine: loads a workload once, then runs every policy over it
+ * repeatedly with time scaled to 0, so only the engine itself is measured
+ */
+#define REQUIRED_ARGS      4
+#define USAGE              "Usage: %s <Processes.csv> <Time-Quantum> <Iterations>\n"
+#define BENCH_INTRO        "%-12s %12s %14s %14s\n"
+#define BENCH_POLICY       "%-12s %12d %14.1f %14.3f\n"
+
+void CountEvent(const SchedulerEvent* event, void* context);
+
+
+
+int main(const int argc, const char* const * argv)
+{
+    if (argc < REQUIRED_ARGS)
+    {
+        printf(USAGE, argv[0]);
+        exit(1);
+    }
+
+    const char* processesCsvFilePath = argv[1];
+    int timeQuantum = atoi(argv[2]);
+    int iterations = atoi(argv[3]);
+    if (timeQuantum <= 0 || iterations <= 0)
+    {
+        printf(USAGE, argv[0]);
+        exit(1);
+    }
+
+    static Process procs[MAX_PROC];
+    int procsCount = 0;
+    SchedulerError error = InitProcessesFromCSV(processesCsvFilePath, procs, &procsCount);
+    if (error != SCHEDULER_OK)
+    {
+        fprintf(stderr, "Failed loading %s: %s\n", processesCsvFilePath, SchedulerErrorString(error));
+        exit(EXIT_FAILURE);
+    }
+
+
+
+    SchedulerOptions options = DefaultSchedulerOptions();
+    options.timeUnitNs = 0;
+
+    printf(BENCH_INTRO, "Policy", "Runs", "Runs/s", "Events/run");
+    for (int policy = 0; policy < SCHEDULER_POLICIES_COUNT; policy++)
+    {
+        long eventsCount = 0;
+        SchedulerMetrics metrics;
+        struct timespec startingTime;
+        struct timespec endingTime;
+
+        clock_gettime(CLOCK_MONOTONIC, &startingTime);
+        for (int i = 0; i < iterations; i++)
+        {
+            error = RunPolicy(policy, timeQuantum, procs, procsCount, options, CountEvent, &eventsCount, &metrics);
+            if (error != SCHEDULER_OK)
+            {
+                fprintf(stderr, "Failed running %s: %s\n", SchedulerPolicyName(policy), SchedulerErrorString(error));
+                exit(EXIT_FAILURE);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &endingTime);
+
+        double elapsed = (double)(endingTime.tv_sec - startingTime.tv_sec) + (double)(endingTime.tv_nsec - startingTime.tv_nsec) / 1e9;
+        printf(BENCH_POLICY, SchedulerPolicyName(policy), iterations, elapsed > 0 ? iterations / elapsed : 0.0, (double)eventsCount / iterations);
+    }
+
+    exit(0);
+}
+
+void CountEvent(const SchedulerEvent* event, void* context)
+{
+    (void)event;
+    (*(long*)context)++;
+}
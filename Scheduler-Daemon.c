@@ -0,0 +1,840 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Scheduler-Daemon.h"
+
+#define DAEMON_BACKLOG 128
+#define DAEMON_MAX_CONNECTIONS 1024
+#define DAEMON_CACHE_SIZE 32
+#define DAEMON_INPUT_BUFFER 4096
+#define DAEMON_OUTPUT_BUFFER (64 * 1024)
+#define DAEMON_MAX_POLICIES 16
+#define DAEMON_EPOLL_EVENTS 64
+#define DAEMON_SEND_TIMEOUT 10
+#define DAEMON_REASON_SIZE 256
+
+#define REQUEST_RUN "RUN"
+#define REQUEST_INLINE_PATH "-"
+#define REQUEST_INLINE_END "."
+#define REQUEST_ALL_POLICIES "all"
+#define REQUEST_POLICY_DELIMS ","
+#define REPLY_OK "OK\n"
+#define REPLY_ERROR "ERROR %s\n"
+#define REPLY_MALFORMED "Malformed request"
+#define REPLY_UNKNOWN_POLICY "Unknown policy"
+#define REPLY_TOO_LONG "Request too long"
+#define REPLY_TOO_MANY_CONNECTIONS "Too many connections"
+
+#define DAEMON_INTRO "Scheduler daemon listening on %s with %d workers\n"
+#define DAEMON_OUTRO "Scheduler daemon served %ld requests (%ld workload cache hits, %ld misses)\n"
+
+
+/*
+ * A parsed workload file, valid as long as the file's identity, size and modification time stay the same
+ */
+typedef struct
+{
+    char path[PATH_MAX];
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    struct timespec modificationTime;
+    unsigned long lastUsed;
+    int procsCount;
+    Process* procs;
+} CachedWorkload;
+
+/*
+ * A client connection. What the client sent is gathered in 'buffer' by the accepting thread until it holds a whole
+ * request of 'requestLength' bytes, and the connection is then busy: a worker owns it, and the accepting thread
+ * stops watching it until the worker hands it back.
+ */
+typedef struct
+{
+    int fd;
+    int slot;
+    FILE* output;
+    char* buffer;
+    size_t length;
+    size_t capacity;
+    size_t requestLength;
+    bool isBusy;
+    bool hasHungUp;
+    time_t lastActive;
+} DaemonConnection;
+
+/*
+ * Connections holding a whole request wait in 'pending', a ring, until a worker takes them. A connection is queued
+ * at most once, so the ring never fills. Everything but the cache's workloads is guarded by 'lock'.
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t hasRequests;
+    DaemonConnection* pending[DAEMON_MAX_CONNECTIONS];
+    int pendingHead;
+    int pendingCount;
+    DaemonConnection* connections[DAEMON_MAX_CONNECTIONS];
+    int epollFd;
+    time_t lastSweep;
+    bool isAcceptPaused;
+
+    CachedWorkload cache[DAEMON_CACHE_SIZE];
+    unsigned long cacheClock;
+    long cacheHits;
+    long cacheMisses;
+    long requestsCount;
+} SchedulerDaemon;
+
+typedef struct
+{
+    const char* name;
+    SchedulerPolicy policy;
+} PolicyName;
+
+static const PolicyName POLICY_NAMES[] =
+{
+    { "FCFS", SCHEDULER_POLICY_FCFS },
+    { "SJF", SCHEDULER_POLICY_SJF },
+    { "Priority", SCHEDULER_POLICY_PRIORITY },
+    { "RR", SCHEDULER_POLICY_ROUND_ROBIN }
+};
+
+static volatile sig_atomic_t isStopping = 0;
+
+
+void StopDaemon(int signal);
+SchedulerError ListenOnSocket(const char* socketPath, int* olistenFd);
+SchedulerError AcceptClient(SchedulerDaemon* daemon, int listenFd);
+void ReadFromClient(SchedulerDaemon* daemon, DaemonConnection* connection);
+void DispatchConnection(SchedulerDaemon* daemon, DaemonConnection* connection);
+long GetRequestLength(const DaemonConnection* connection);
+void CloseConnection(SchedulerDaemon* daemon, DaemonConnection* connection);
+void CloseIdleConnections(SchedulerDaemon* daemon);
+void RejectClient(int clientFd, const char* reason);
+time_t GetMonotonicSeconds();
+void* RunDaemonWorker(void* context);
+void ServeRequest(SchedulerDaemon* daemon, DaemonConnection* connection, Process procs[]);
+bool SplitRequest(char* request, char** ocommand, char** oquantumText, char** opoliciesText, char** opath);
+const char* HandleRequest(SchedulerDaemon* daemon, char* request, FILE* input, FILE* output, Process procs[], char reason[]);
+bool ParsePolicies(char* text, SchedulerPolicy opolicies[], int* opoliciesCount);
+SchedulerError ReadInlineProcesses(FILE* input, Process oprocs[], int* oprocsCount);
+SchedulerError GetWorkload(SchedulerDaemon* daemon, const char* path, Process oprocs[], int* oprocsCount);
+const char* GetErrorReason(SchedulerError error, char reason[]);
+
+
+
+SchedulerError HandleSchedulerDaemon(const char* socketPath, int workersCount)
+{
+    if (workersCount <= 0 || workersCount > DAEMON_MAX_WORKERS)
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+
+    SchedulerDaemon* daemon = calloc(1, sizeof(SchedulerDaemon));
+    if (daemon == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+    pthread_mutex_init(&daemon->lock, NULL);
+    pthread_cond_init(&daemon->hasRequests, NULL);
+
+    int listenFd = -1;
+    SchedulerError error = ListenOnSocket(socketPath, &listenFd);
+    if (error != SCHEDULER_OK)
+    {
+        free(daemon);
+        return error;
+    }
+
+    struct epoll_event listenEvent = { 0 };
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.ptr = NULL;
+    daemon->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (daemon->epollFd == -1 || epoll_ctl(daemon->epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) == -1)
+    {
+        int savedErrno = errno;
+        if (daemon->epollFd != -1)
+            close(daemon->epollFd);
+        close(listenFd);
+        unlink(socketPath);
+        free(daemon);
+        errno = savedErrno;
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+    daemon->lastSweep = GetMonotonicSeconds();
+
+
+
+    /*
+     * A client hanging up must only end its own connection, and stopping is left to the accepting thread: the
+     * workers start with SIGINT and SIGTERM blocked, and epoll_wait() returns once they arrive
+     */
+    struct sigaction action = { 0 };
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, NULL);
+    action.sa_handler = StopDaemon;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    sigset_t stopSignals;
+    sigset_t previousSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &previousSignals);
+    for (int i = 0; error == SCHEDULER_OK && i < workersCount; i++)
+    {
+        pthread_t worker;
+        int result = pthread_create(&worker, NULL, RunDaemonWorker, daemon);
+        if (result != 0)
+        {
+            errno = result;
+            error = SCHEDULER_ERROR_SYSTEM;
+        }
+        else
+            pthread_detach(worker);
+    }
+    pthread_sigmask(SIG_SETMASK, &previousSignals, NULL);
+
+    if (error == SCHEDULER_OK)
+        fprintf(stderr, DAEMON_INTRO, socketPath, workersCount);
+
+
+
+    /*
+     * The accepting thread watches the listening socket and every connection which is not busy, and wakes up at
+     * least once a second to close the connections idle for too long. Accepting pauses until then when the
+     * process runs out of descriptors, as the pending connection would otherwise wake it up again at once.
+     */
+    while (error == SCHEDULER_OK && !isStopping)
+    {
+        struct epoll_event events[DAEMON_EPOLL_EVENTS];
+        int eventsCount = epoll_wait(daemon->epollFd, events, DAEMON_EPOLL_EVENTS, 1000);
+        if (eventsCount == -1)
+        {
+            if (errno != EINTR)
+                error = SCHEDULER_ERROR_SYSTEM;
+            continue;
+        }
+
+        for (int i = 0; error == SCHEDULER_OK && i < eventsCount; i++)
+        {
+            if (events[i].data.ptr == NULL)
+                error = AcceptClient(daemon, listenFd);
+            else
+                ReadFromClient(daemon, events[i].data.ptr);
+        }
+
+        time_t lastSweep = daemon->lastSweep;
+        CloseIdleConnections(daemon);
+        if (daemon->isAcceptPaused && daemon->lastSweep != lastSweep)
+        {
+            daemon->isAcceptPaused = false;
+            epoll_ctl(daemon->epollFd, EPOLL_CTL_MOD, listenFd, &listenEvent);
+        }
+    }
+
+
+
+    /*
+     * Workers still serving a request end with the process
+     */
+    int savedErrno = errno;
+    close(listenFd);
+    unlink(socketPath);
+    if (error == SCHEDULER_OK)
+    {
+        pthread_mutex_lock(&daemon->lock);
+        fprintf(stderr, DAEMON_OUTRO, daemon->requestsCount, daemon->cacheHits, daemon->cacheMisses);
+        pthread_mutex_unlock(&daemon->lock);
+    }
+    errno = savedErrno;
+
+    return error;
+}
+
+void StopDaemon(int signal)
+{
+    (void)signal;
+    isStopping = 1;
+}
+
+/*
+ * A socket left behind by a previous daemon is replaced, any other file at socketPath is not
+ */
+SchedulerError ListenOnSocket(const char* socketPath, int* olistenFd)
+{
+    struct sockaddr_un address = { 0 };
+    struct stat status;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+
+    if (lstat(socketPath, &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(socketPath);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd == -1)
+        return SCHEDULER_ERROR_SYSTEM;
+    if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) == -1 || listen(listenFd, DAEMON_BACKLOG) == -1)
+    {
+        int savedErrno = errno;
+        close(listenFd);
+        errno = savedErrno;
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+
+    *olistenFd = listenFd;
+    return SCHEDULER_OK;
+}
+
+/*
+ * A client which cannot be given a connection is told so and hung up on. Replies to a client which stops reading
+ * time out after DAEMON_SEND_TIMEOUT seconds, so that it cannot hold a worker.
+ */
+SchedulerError AcceptClient(SchedulerDaemon* daemon, int listenFd)
+{
+    int clientFd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+    if (clientFd == -1 && (errno == EMFILE || errno == ENFILE))
+    {
+        struct epoll_event event = { 0 };
+        daemon->isAcceptPaused = true;
+        return epoll_ctl(daemon->epollFd, EPOLL_CTL_MOD, listenFd, &event) == -1 ? SCHEDULER_ERROR_SYSTEM : SCHEDULER_OK;
+    }
+    if (clientFd == -1)
+        return (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) ? SCHEDULER_OK : SCHEDULER_ERROR_SYSTEM;
+
+    int slot = 0;
+    pthread_mutex_lock(&daemon->lock);
+    while (slot < DAEMON_MAX_CONNECTIONS && daemon->connections[slot] != NULL)
+        slot++;
+    pthread_mutex_unlock(&daemon->lock);
+    if (slot == DAEMON_MAX_CONNECTIONS)
+    {
+        RejectClient(clientFd, REPLY_TOO_MANY_CONNECTIONS);
+        close(clientFd);
+        return SCHEDULER_OK;
+    }
+
+    struct timeval sendTimeout = { .tv_sec = DAEMON_SEND_TIMEOUT };
+    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+    DaemonConnection* connection = calloc(1, sizeof(DaemonConnection));
+    int outputFd = dup(clientFd);
+    FILE* output = outputFd != -1 ? fdopen(outputFd, "w") : NULL;
+    struct epoll_event event = { 0 };
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = connection;
+    if (connection == NULL || output == NULL || epoll_ctl(daemon->epollFd, EPOLL_CTL_ADD, clientFd, &event) == -1)
+    {
+        char reasonBuffer[DAEMON_REASON_SIZE];
+        const char* reason = GetErrorReason(SCHEDULER_ERROR_SYSTEM, reasonBuffer);
+        if (output != NULL)
+            fclose(output);
+        else if (outputFd != -1)
+            close(outputFd);
+        free(connection);
+        RejectClient(clientFd, reason);
+        close(clientFd);
+        return SCHEDULER_OK;
+    }
+    setvbuf(output, NULL, _IOFBF, DAEMON_OUTPUT_BUFFER);
+
+    connection->fd = clientFd;
+    connection->slot = slot;
+    connection->output = output;
+    connection->lastActive = GetMonotonicSeconds();
+    pthread_mutex_lock(&daemon->lock);
+    daemon->connections[slot] = connection;
+    pthread_mutex_unlock(&daemon->lock);
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * Gathers whatever the client sent without blocking, up to DAEMON_MAX_REQUEST bytes. A last line the client left
+ * unterminated before hanging up is terminated, so that it is still served.
+ */
+void ReadFromClient(SchedulerDaemon* daemon, DaemonConnection* connection)
+{
+    while (!connection->hasHungUp)
+    {
+        if (connection->length == connection->capacity)
+        {
+            if (connection->capacity == DAEMON_MAX_REQUEST)
+                break;
+
+            size_t capacity = connection->capacity == 0 ? DAEMON_INPUT_BUFFER : connection->capacity * 2;
+            if (capacity > DAEMON_MAX_REQUEST)
+                capacity = DAEMON_MAX_REQUEST;
+            char* buffer = realloc(connection->buffer, capacity + 1);
+            if (buffer == NULL)
+            {
+                CloseConnection(daemon, connection);
+                return;
+            }
+            connection->buffer = buffer;
+            connection->capacity = capacity;
+        }
+
+        ssize_t readCount = recv(connection->fd, connection->buffer + connection->length,
+            connection->capacity - connection->length, MSG_DONTWAIT);
+        if (readCount > 0)
+            connection->length += readCount;
+        else if (readCount == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else if (readCount == 0 || errno != EINTR)
+            connection->hasHungUp = true;
+    }
+
+    if (connection->hasHungUp && connection->length > 0 && connection->buffer[connection->length - 1] != '\n')
+        connection->buffer[connection->length++] = '\n';
+
+    DispatchConnection(daemon, connection);
+}
+
+/*
+ * Queues the connection to the workers once it holds a whole request, and otherwise hands it back to the
+ * accepting thread to wait for more, unless the client hung up or went past the limits
+ */
+void DispatchConnection(SchedulerDaemon* daemon, DaemonConnection* connection)
+{
+    long requestLength = GetRequestLength(connection);
+
+    if (requestLength < 0 || (requestLength == 0 && connection->length >= DAEMON_MAX_REQUEST))
+    {
+        RejectClient(connection->fd, REPLY_TOO_LONG);
+        CloseConnection(daemon, connection);
+    }
+    else if (requestLength > 0)
+    {
+        pthread_mutex_lock(&daemon->lock);
+        connection->isBusy = true;
+        connection->requestLength = requestLength;
+        daemon->pending[(daemon->pendingHead + daemon->pendingCount) % DAEMON_MAX_CONNECTIONS] = connection;
+        daemon->pendingCount++;
+        pthread_cond_signal(&daemon->hasRequests);
+        pthread_mutex_unlock(&daemon->lock);
+    }
+    else if (connection->hasHungUp)
+        CloseConnection(daemon, connection);
+    else
+    {
+        pthread_mutex_lock(&daemon->lock);
+        connection->isBusy = false;
+        connection->lastActive = GetMonotonicSeconds();
+        pthread_mutex_unlock(&daemon->lock);
+
+        struct epoll_event event = { 0 };
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.ptr = connection;
+        epoll_ctl(daemon->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+    }
+}
+
+/*
+ * Returns the length of the request at the start of the buffer, 0 if the client did not send all of it yet, or -1
+ * if one of its lines is longer than DAEMON_MAX_LINE. An inline request ends with its terminating line, or with
+ * the client hanging up.
+ */
+long GetRequestLength(const DaemonConnection* connection)
+{
+    const char* buffer = connection->buffer;
+    size_t length = connection->length;
+
+    if (length == 0)
+        return 0;
+    const char* lineEnd = memchr(buffer, '\n', length);
+    if (lineEnd == NULL)
+        return length > DAEMON_MAX_LINE ? -1 : 0;
+    size_t offset = lineEnd - buffer + 1;
+    if (offset > DAEMON_MAX_LINE)
+        return -1;
+
+    char line[DAEMON_MAX_LINE + 1];
+    char* command;
+    char* quantumText;
+    char* policiesText;
+    char* path;
+    memcpy(line, buffer, offset);
+    line[offset] = '\0';
+    if (!SplitRequest(line, &command, &quantumText, &policiesText, &path) || strcmp(path, REQUEST_INLINE_PATH) != 0)
+        return offset;
+
+
+
+    while (offset < length)
+    {
+        const char* row = buffer + offset;
+        const char* rowEnd = memchr(row, '\n', length - offset);
+        if (rowEnd == NULL)
+            return length - offset > DAEMON_MAX_LINE ? -1 : 0;
+        size_t rowLength = rowEnd - row + 1;
+        if (rowLength > DAEMON_MAX_LINE)
+            return -1;
+
+        offset += rowLength;
+        while (rowLength > 0 && (row[rowLength - 1] == '\n' || row[rowLength - 1] == '\r'))
+            rowLength--;
+        if (rowLength == strlen(REQUEST_INLINE_END) && memcmp(row, REQUEST_INLINE_END, rowLength) == 0)
+            return offset;
+    }
+
+    return connection->hasHungUp ? (long)length : 0;
+}
+
+/*
+ * Only the accepting thread closes a connection which is not busy, and only the worker owning it one which is
+ */
+void CloseConnection(SchedulerDaemon* daemon, DaemonConnection* connection)
+{
+    /*
+     * The output stream holds a duplicate of the descriptor, which would keep it watched past close()
+     */
+    epoll_ctl(daemon->epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    pthread_mutex_lock(&daemon->lock);
+    daemon->connections[connection->slot] = NULL;
+    pthread_mutex_unlock(&daemon->lock);
+
+    fclose(connection->output);
+    free(connection->buffer);
+    free(connection);
+}
+
+void CloseIdleConnections(SchedulerDaemon* daemon)
+{
+    time_t now = GetMonotonicSeconds();
+    if (now == daemon->lastSweep)
+        return;
+    daemon->lastSweep = now;
+
+    for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++)
+    {
+        pthread_mutex_lock(&daemon->lock);
+        DaemonConnection* connection = daemon->connections[i];
+        bool isIdle = connection != NULL && !connection->isBusy && now - connection->lastActive >= DAEMON_IDLE_TIMEOUT;
+        pthread_mutex_unlock(&daemon->lock);
+
+        if (isIdle)
+            CloseConnection(daemon, connection);
+    }
+}
+
+/*
+ * Tells the client why it is about to be hung up on, if it can be told without waiting
+ */
+void RejectClient(int clientFd, const char* reason)
+{
+    char reply[DAEMON_MAX_LINE];
+    int replyLength = snprintf(reply, sizeof(reply), REPLY_ERROR, reason);
+
+    if (replyLength > 0)
+        send(clientFd, reply, replyLength < (int)sizeof(reply) ? replyLength : (int)sizeof(reply) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+time_t GetMonotonicSeconds()
+{
+    struct timespec currentTime;
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+    return currentTime.tv_sec;
+}
+
+void* RunDaemonWorker(void* context)
+{
+    SchedulerDaemon* daemon = context;
+    Process* procs = malloc(MAX_PROC * sizeof(Process));
+
+    while (true)
+    {
+        pthread_mutex_lock(&daemon->lock);
+        while (daemon->pendingCount == 0)
+            pthread_cond_wait(&daemon->hasRequests, &daemon->lock);
+        DaemonConnection* connection = daemon->pending[daemon->pendingHead];
+        daemon->pendingHead = (daemon->pendingHead + 1) % DAEMON_MAX_CONNECTIONS;
+        daemon->pendingCount--;
+        pthread_mutex_unlock(&daemon->lock);
+
+        if (procs == NULL)
+            CloseConnection(daemon, connection);
+        else
+            ServeRequest(daemon, connection, procs);
+    }
+
+    return NULL;
+}
+
+/*
+ * Answers the connection's first request, which is whole in its buffer, then dispatches the connection again: a
+ * client pipelining requests goes back to the end of the queue rather than keeping the worker. The reply is
+ * buffered and flushed once.
+ */
+void ServeRequest(SchedulerDaemon* daemon, DaemonConnection* connection, Process procs[])
+{
+    char reasonBuffer[DAEMON_REASON_SIZE];
+    const char* reason;
+    char* line = NULL;
+    size_t line_length = 0;
+
+    FILE* input = fmemopen(connection->buffer, connection->requestLength, "r");
+    if (input == NULL)
+        reason = GetErrorReason(SCHEDULER_ERROR_SYSTEM, reasonBuffer);
+    else
+    {
+        if (getline(&line, &line_length, input) > 0)
+            reason = HandleRequest(daemon, line, input, connection->output, procs, reasonBuffer);
+        else
+            reason = GetErrorReason(SCHEDULER_ERROR_SYSTEM, reasonBuffer);
+        fclose(input);
+    }
+    free(line);
+
+    if (reason == NULL)
+        fprintf(connection->output, REPLY_OK);
+    else
+        fprintf(connection->output, REPLY_ERROR, reason);
+
+    connection->length -= connection->requestLength;
+    memmove(connection->buffer, connection->buffer + connection->requestLength, connection->length);
+    if (fflush(connection->output) != 0)
+        CloseConnection(daemon, connection);
+    else
+        DispatchConnection(daemon, connection);
+}
+
+bool SplitRequest(char* request, char** ocommand, char** oquantumText, char** opoliciesText, char** opath)
+{
+    char* save_ptr = NULL;
+
+    *ocommand = strtok_r(request, " \t\r\n", &save_ptr);
+    *oquantumText = strtok_r(NULL, " \t\r\n", &save_ptr);
+    *opoliciesText = strtok_r(NULL, " \t\r\n", &save_ptr);
+    *opath = strtok_r(NULL, "\r\n", &save_ptr);
+
+    return *ocommand != NULL && *opath != NULL && strcmp(*ocommand, REQUEST_RUN) == 0;
+}
+
+/*
+ * Returns why the request failed, NULL if it succeeded. 'reason' holds DAEMON_REASON_SIZE bytes for the failure
+ * to be described in.
+ */
+const char* HandleRequest(SchedulerDaemon* daemon, char* request, FILE* input, FILE* output, Process procs[], char reason[])
+{
+    char* command;
+    char* quantumText;
+    char* policiesText;
+    char* path;
+    SchedulerPolicy policies[DAEMON_MAX_POLICIES];
+    int policiesCount = 0;
+    int procsCount = 0;
+    SchedulerError error;
+
+    if (!SplitRequest(request, &command, &quantumText, &policiesText, &path))
+        return REPLY_MALFORMED;
+
+    int timeQuantum = atoi(quantumText);
+    bool arePoliciesValid = ParsePolicies(policiesText, policies, &policiesCount);
+
+
+
+    if (!arePoliciesValid || timeQuantum <= 0)
+        error = SCHEDULER_OK;
+    else if (strcmp(path, REQUEST_INLINE_PATH) == 0)
+        error = ReadInlineProcesses(input, procs, &procsCount);
+    else
+        error = GetWorkload(daemon, path, procs, &procsCount);
+
+    pthread_mutex_lock(&daemon->lock);
+    daemon->requestsCount++;
+    pthread_mutex_unlock(&daemon->lock);
+
+    if (!arePoliciesValid)
+        return REPLY_UNKNOWN_POLICY;
+    if (timeQuantum <= 0)
+        return GetErrorReason(SCHEDULER_ERROR_INVALID_ARGUMENT, reason);
+    if (error != SCHEDULER_OK)
+        return GetErrorReason(error, reason);
+
+
+
+    SchedulerOptions options = DefaultSchedulerOptions();
+    options.timeUnitNs = 0;
+    for (int i = 0; i < policiesCount; i++)
+    {
+        SchedulerMetrics metrics;
+        if ((error = PrintPolicyReport(output, policies[i], timeQuantum, procs, procsCount, options, &metrics)) != SCHEDULER_OK)
+            return GetErrorReason(error, reason);
+    }
+
+    return NULL;
+}
+
+bool ParsePolicies(char* text, SchedulerPolicy opolicies[], int* opoliciesCount)
+{
+    char* save_ptr = NULL;
+
+    *opoliciesCount = 0;
+    if (text == NULL)
+        return false;
+
+    if (strcasecmp(text, REQUEST_ALL_POLICIES) == 0)
+    {
+        for (int policy = 0; policy < SCHEDULER_POLICIES_COUNT; policy++)
+            opolicies[(*opoliciesCount)++] = policy;
+        return true;
+    }
+
+    for (char* name = strtok_r(text, REQUEST_POLICY_DELIMS, &save_ptr); name != NULL; name = strtok_r(NULL, REQUEST_POLICY_DELIMS, &save_ptr))
+    {
+        int i = 0;
+        int namesCount = sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0]);
+        while (i < namesCount && strcasecmp(name, POLICY_NAMES[i].name) != 0)
+            i++;
+        if (i == namesCount || *opoliciesCount == DAEMON_MAX_POLICIES)
+            return false;
+        opolicies[(*opoliciesCount)++] = POLICY_NAMES[i].policy;
+    }
+
+    return *opoliciesCount > 0;
+}
+
+/*
+ * Reads rows up to the terminating line, numbering them the way InitProcessesFromCSV() does
+ */
+SchedulerError ReadInlineProcesses(FILE* input, Process oprocs[], int* oprocsCount)
+{
+    SchedulerError error = SCHEDULER_OK;
+    char* line = NULL;
+    size_t line_length = 0;
+    bool isTerminated = false;
+
+    *oprocsCount = 0;
+    while (getline(&line, &line_length, input) > 0)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strcmp(line, REQUEST_INLINE_END) == 0)
+        {
+            isTerminated = true;
+            break;
+        }
+        if (error != SCHEDULER_OK)
+            continue;
+
+        if (*oprocsCount >= MAX_PROC)
+            error = SCHEDULER_ERROR_TOO_MANY_PROCESSES;
+        else if ((error = ParseProcess(line, &oprocs[*oprocsCount])) == SCHEDULER_OK)
+        {
+            oprocs[*oprocsCount].original_idx = *oprocsCount;
+            (*oprocsCount)++;
+        }
+    }
+
+    free(line);
+    if (error == SCHEDULER_OK && !isTerminated)
+        error = SCHEDULER_ERROR_PARSE;
+
+    return error;
+}
+
+/*
+ * Copies the workload at 'path' out of the cache, parsing it first if it is not there or changed on disk. The
+ * least recently used workload makes room for a new one.
+ */
+SchedulerError GetWorkload(SchedulerDaemon* daemon, const char* path, Process oprocs[], int* oprocsCount)
+{
+    struct stat status;
+    if (stat(path, &status) == -1)
+        return SCHEDULER_ERROR_SYSTEM;
+
+    pthread_mutex_lock(&daemon->lock);
+    CachedWorkload* entry = NULL;
+    for (int i = 0; i < DAEMON_CACHE_SIZE && entry == NULL; i++)
+    {
+        CachedWorkload* candidate = &daemon->cache[i];
+        if (candidate->procs != NULL && strcmp(candidate->path, path) == 0 && candidate->device == status.st_dev &&
+            candidate->inode == status.st_ino && candidate->size == status.st_size &&
+            candidate->modificationTime.tv_sec == status.st_mtim.tv_sec && candidate->modificationTime.tv_nsec == status.st_mtim.tv_nsec)
+            entry = candidate;
+    }
+
+    if (entry != NULL)
+    {
+        entry->lastUsed = ++daemon->cacheClock;
+        daemon->cacheHits++;
+        *oprocsCount = entry->procsCount;
+        memcpy(oprocs, entry->procs, entry->procsCount * sizeof(Process));
+        pthread_mutex_unlock(&daemon->lock);
+        return SCHEDULER_OK;
+    }
+    daemon->cacheMisses++;
+    pthread_mutex_unlock(&daemon->lock);
+
+
+
+    /*
+     * Parsing happens outside the lock, two workers missing on the same file at once both parse it
+     */
+    SchedulerError error = InitProcessesFromCSV(path, oprocs, oprocsCount);
+    if (error != SCHEDULER_OK || strlen(path) >= PATH_MAX)
+        return error;
+    /*
+     * Failing to cache the workload only costs parsing it again next time
+     */
+    Process* procs = malloc(*oprocsCount * sizeof(Process) + 1);
+    if (procs == NULL)
+        return SCHEDULER_OK;
+    memcpy(procs, oprocs, *oprocsCount * sizeof(Process));
+
+    pthread_mutex_lock(&daemon->lock);
+    entry = &daemon->cache[0];
+    for (int i = 0; i < DAEMON_CACHE_SIZE; i++)
+    {
+        CachedWorkload* candidate = &daemon->cache[i];
+        if (candidate->procs != NULL && strcmp(candidate->path, path) == 0)
+        {
+            entry = candidate;
+            break;
+        }
+        if (candidate->procs == NULL || (entry->procs != NULL && candidate->lastUsed < entry->lastUsed))
+            entry = candidate;
+    }
+    free(entry->procs);
+    strcpy(entry->path, path);
+    entry->device = status.st_dev;
+    entry->inode = status.st_ino;
+    entry->size = status.st_size;
+    entry->modificationTime = status.st_mtim;
+    entry->lastUsed = ++daemon->cacheClock;
+    entry->procsCount = *oprocsCount;
+    entry->procs = procs;
+    pthread_mutex_unlock(&daemon->lock);
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * Describes errno into 'reason', of DAEMON_REASON_SIZE bytes, for a system error: workers fail concurrently, and
+ * strerror() may share its buffer between them
+ */
+const char* GetErrorReason(SchedulerError error, char reason[])
+{
+    if (error == SCHEDULER_ERROR_SYSTEM)
+        return strerror_r(errno, reason, DAEMON_REASON_SIZE);
+
+    return SchedulerErrorString(error);
+}
@@ -0,0 +1,31 @@
+#ifndef SCHEDULER_DAEMON_H
+#define SCHEDULER_DAEMON_H
+
+#include "CPU-Scheduler.h"
+
+/*
+ * Daemon mode: serves scheduling requests over a Unix domain socket, so that a client evaluating many workloads
+ * pays neither process startup nor reparsing for each of them. Requests are served by a pool of worker threads,
+ * and parsed workload files are kept in memory until they change on disk.
+ *
+ * A connection sends any number of requests, one per line:
+ *   RUN <Time-Quantum> <Policies> <Processes.csv>
+ *   RUN <Time-Quantum> <Policies> -        followed by the process rows and a line holding a single '.'
+ * <Policies> is a comma separated list of FCFS, SJF, Priority and RR, or "all". Each request is answered with
+ * the report of every policy listed, as CPU-Scheduler prints it with time scaled to 0, followed by a line holding
+ * "OK", or "ERROR <reason>" if the request failed.
+ *
+ * Workers are handed whole requests rather than connections, so that idle clients hold none of them. A line longer
+ * than DAEMON_MAX_LINE bytes, or a request longer than DAEMON_MAX_REQUEST bytes, is answered with an error and the
+ * connection is closed, as is a connection idle for DAEMON_IDLE_TIMEOUT seconds.
+ */
+#define DAEMON_DEFAULT_WORKERS 4
+#define DAEMON_MAX_WORKERS 64
+#define DAEMON_MAX_LINE 8192
+#define DAEMON_MAX_REQUEST (1024 * 1024)
+#define DAEMON_IDLE_TIMEOUT 60
+
+
+SchedulerError HandleSchedulerDaemon(const char* socketPath, int workersCount);
+
+#endif
@@ -0,0 +1,212 @@
+#include "Timing-Wheel.h"
+
+
+
+void TimerWheelPlace(TimerWheel* wheel, int entryIdx);
+int TimerWheelTakeSlot(TimerWheel* wheel, int level, int slot);
+
+
+
+void TimerWheelInit(TimerWheel* wheel, int currentTime)
+{
+    wheel->currentTime = currentTime;
+    wheel->size = 0;
+
+    for (int level = 0; level <= WHEEL_LEVELS; level++)
+        for (int slot = 0; slot < WHEEL_SLOTS; slot++)
+        {
+            wheel->heads[level][slot] = WHEEL_NIL;
+            wheel->tails[level][slot] = WHEEL_NIL;
+        }
+    for (int level = 0; level < WHEEL_LEVELS; level++)
+        wheel->occupied[level] = 0;
+
+
+
+    /*
+     * Chaining every entry into the free list
+     */
+    for (int i = 0; i < WHEEL_CAPACITY - 1; i++)
+        wheel->entries[i].next = i + 1;
+    wheel->entries[WHEEL_CAPACITY - 1].next = WHEEL_NIL;
+    wheel->freeHead = 0;
+}
+
+/*
+ * Returns false if the wheel is already holding WHEEL_CAPACITY entries
+ */
+bool TimerWheelInsert(TimerWheel* wheel, int expires, int kind, int payload)
+{
+    if (wheel->freeHead == WHEEL_NIL)
+        return false;
+
+    int entryIdx = wheel->freeHead;
+    wheel->freeHead = wheel->entries[entryIdx].next;
+    wheel->size++;
+
+
+
+    /*
+     * Entries in the past expire on the next advance
+     */
+    wheel->entries[entryIdx].expires = expires < wheel->currentTime ? wheel->currentTime : expires;
+    wheel->entries[entryIdx].kind = kind;
+    wheel->entries[entryIdx].payload = payload;
+    TimerWheelPlace(wheel, entryIdx);
+
+    return true;
+}
+
+bool TimerWheelIsEmpty(const TimerWheel* wheel)
+{
+    return wheel->size == 0;
+}
+
+/*
+ * Returns the earliest expiry time in the wheel, or -1 if it is empty
+ */
+int TimerWheelNextExpiry(const TimerWheel* wheel)
+{
+    if (wheel->occupied[0] != 0)
+        return (wheel->currentTime & ~(WHEEL_SLOTS - 1)) | __builtin_ctzll(wheel->occupied[0]);
+
+
+
+    /*
+     * Lower levels always expire before higher ones, so only the first occupied slot of the lowest non empty level
+     * (or the overflow list) has to be scanned
+     */
+    int entryIdx = WHEEL_NIL;
+    for (int level = 1; level < WHEEL_LEVELS && entryIdx == WHEEL_NIL; level++)
+        if (wheel->occupied[level] != 0)
+            entryIdx = wheel->heads[level][__builtin_ctzll(wheel->occupied[level])];
+    if (entryIdx == WHEEL_NIL)
+        entryIdx = wheel->heads[WHEEL_OVERFLOW][0];
+
+    int nextExpiry = -1;
+    for (; entryIdx != WHEEL_NIL; entryIdx = wheel->entries[entryIdx].next)
+        if (nextExpiry == -1 || wheel->entries[entryIdx].expires < nextExpiry)
+            nextExpiry = wheel->entries[entryIdx].expires;
+
+    return nextExpiry;
+}
+
+/*
+ * Moves the wheel's current time forward to 'time', calling onExpiry for every entry which expires on the way,
+ * in expiry order. The entry is released before the callback runs, so the callback may insert new entries.
+ */
+void TimerWheelAdvance(TimerWheel* wheel, int time, void (*onExpiry)(TimerWheelEntry, void*), void* context)
+{
+    while (true)
+    {
+        /*
+         * Firing the next level 0 slot if it is due
+         */
+        if (wheel->occupied[0] != 0)
+        {
+            int slot = __builtin_ctzll(wheel->occupied[0]);
+            int slotTime = (wheel->currentTime & ~(WHEEL_SLOTS - 1)) | slot;
+            if (slotTime > time)
+                break;
+
+            wheel->currentTime = slotTime;
+            int entryIdx = TimerWheelTakeSlot(wheel, 0, slot);
+            while (entryIdx != WHEEL_NIL)
+            {
+                TimerWheelEntry entry = wheel->entries[entryIdx];
+                int next = entry.next;
+
+                wheel->entries[entryIdx].next = wheel->freeHead;
+                wheel->freeHead = entryIdx;
+                wheel->size--;
+
+                onExpiry(entry, context);
+                entryIdx = next;
+            }
+            continue;
+        }
+
+
+
+        /*
+         * Level 0 is empty, jumping to the start of the first occupied slot of the lowest non empty level and
+         * cascading its entries down
+         */
+        int level = 1;
+        while (level < WHEEL_LEVELS && wheel->occupied[level] == 0)
+            level++;
+
+        int slot = 0;
+        int slotTime;
+        if (level < WHEEL_LEVELS)
+        {
+            int levelShift = WHEEL_SLOT_BITS * level;
+            slot = __builtin_ctzll(wheel->occupied[level]);
+            slotTime = ((wheel->currentTime >> (levelShift + WHEEL_SLOT_BITS)) << (levelShift + WHEEL_SLOT_BITS)) |
+                       (slot << levelShift);
+        }
+        else if (wheel->heads[WHEEL_OVERFLOW][0] != WHEEL_NIL)
+        {
+            int overflowShift = WHEEL_SLOT_BITS * WHEEL_LEVELS;
+            slotTime = (TimerWheelNextExpiry(wheel) >> overflowShift) << overflowShift;
+        }
+        else
+            break;
+
+        if (slotTime > time)
+            break;
+
+        wheel->currentTime = slotTime;
+        int entryIdx = TimerWheelTakeSlot(wheel, level, slot);
+        while (entryIdx != WHEEL_NIL)
+        {
+            int next = wheel->entries[entryIdx].next;
+            TimerWheelPlace(wheel, entryIdx);
+            entryIdx = next;
+        }
+    }
+
+    if (time > wheel->currentTime)
+        wheel->currentTime = time;
+}
+
+/*
+ * Appends an entry to the slot matching its expiry time relative to the current time
+ */
+void TimerWheelPlace(TimerWheel* wheel, int entryIdx)
+{
+    int expires = wheel->entries[entryIdx].expires;
+    int level = 0;
+    while (level < WHEEL_LEVELS &&
+           (expires >> (WHEEL_SLOT_BITS * (level + 1))) != (wheel->currentTime >> (WHEEL_SLOT_BITS * (level + 1))))
+        level++;
+
+    int slot = 0;
+    if (level < WHEEL_LEVELS)
+    {
+        slot = (expires >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+        wheel->occupied[level] |= 1ULL << slot;
+    }
+
+    wheel->entries[entryIdx].next = WHEEL_NIL;
+    if (wheel->tails[level][slot] == WHEEL_NIL)
+        wheel->heads[level][slot] = entryIdx;
+    else
+        wheel->entries[wheel->tails[level][slot]].next = entryIdx;
+    wheel->tails[level][slot] = entryIdx;
+}
+
+/*
+ * Detaches a slot's list and returns its head
+ */
+int TimerWheelTakeSlot(TimerWheel* wheel, int level, int slot)
+{
+    int head = wheel->heads[level][slot];
+
+    wheel->heads[level][slot] = WHEEL_NIL;
+    wheel->tails[level][slot] = WHEEL_NIL;
+    if (level < WHEEL_LEVELS)
+        wheel->occupied[level] &= ~(1ULL << slot);
+
+    return head;
+}
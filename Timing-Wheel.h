@@ -0,0 +1,50 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Hierarchical timing wheel.
+ *
+ * Level l has WHEEL_SLOTS slots, each WHEEL_SLOTS^l time units wide. An entry is kept on the lowest level whose
+ * higher slot indexes it shares with the wheel's current time, so an insert is a list append, and an entry is only
+ * moved (cascaded) when the current time enters its slot, at most once per level. Entries which are too far ahead
+ * for the top level wait on the overflow list.
+ *
+ * Entries expiring at the same time are delivered in insertion order.
+ */
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_CAPACITY 1024
+#define WHEEL_OVERFLOW WHEEL_LEVELS
+#define WHEEL_NIL -1
+
+typedef struct
+{
+    int expires;
+    int kind;
+    int payload;
+    int next;
+} TimerWheelEntry;
+
+typedef struct
+{
+    int currentTime;
+    int size;
+    int freeHead;
+    int heads[WHEEL_LEVELS + 1][WHEEL_SLOTS];
+    int tails[WHEEL_LEVELS + 1][WHEEL_SLOTS];
+    uint64_t occupied[WHEEL_LEVELS];
+    TimerWheelEntry entries[WHEEL_CAPACITY];
+} TimerWheel;
+
+
+void TimerWheelInit(TimerWheel* wheel, int currentTime);
+bool TimerWheelInsert(TimerWheel* wheel, int expires, int kind, int payload);
+bool TimerWheelIsEmpty(const TimerWheel* wheel);
+int TimerWheelNextExpiry(const TimerWheel* wheel);
+void TimerWheelAdvance(TimerWheel* wheel, int time, void (*onExpiry)(TimerWheelEntry, void*), void* context);
+
+#endif
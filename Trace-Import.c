@@ -0,0 +1,581 @@
+#define _GNU_SOURCE
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Trace-Import.h"
+
+/*
+ * Tasks are kept in an open addressing table (linear probing) twice as large as the number of live tasks
+ */
+#define TRACE_TABLE_SIZE (2 * TRACE_MAX_TASKS)
+
+/*
+ * A full table writes out this many of its least recently active tasks at once, so that the scan it takes is
+ * shared by many new tasks
+ */
+#define TRACE_EVICTION_BATCH (TRACE_MAX_TASKS / 8)
+#define TRACE_DEFAULT_TIME_UNIT_NS 1000000L
+#define TRACE_NICE_0_PRIO 120
+#define TRACE_MAX_STATE 16
+
+#define TRACE_EVENT_SWITCH 0
+#define TRACE_EVENT_WAKEUP 1
+#define TRACE_EVENT_EXIT 2
+
+#define TRACE_RECORD "%s,pid %d,%lld,%lld,%d\n"
+
+
+/*
+ * A task being followed. pid 0 marks a free slot, the idle task is never tracked. cpu is the CPU the task is
+ * running on, -1 if it is off the CPU.
+ */
+typedef struct
+{
+    int pid;
+    char name[MAX_NAME];
+    int prio;
+    long long firstSeenNs;
+    long long runNs;
+    long long lastActiveNs;
+    int cpu;
+    bool hasExited;
+} TraceTask;
+
+/*
+ * What a CPU runs since sinceNs, pid 0 if it is idle or not known yet
+ */
+typedef struct
+{
+    int pid;
+    long long sinceNs;
+} TraceCpu;
+
+/*
+ * A parsed event. Wakeup and exit events only fill the next* fields, with the task they are about.
+ */
+typedef struct
+{
+    int kind;
+    long long timeNs;
+    int cpu;
+    char prevComm[MAX_NAME];
+    int prevPid;
+    int prevPrio;
+    char prevState[TRACE_MAX_STATE];
+    char nextComm[MAX_NAME];
+    int nextPid;
+    int nextPrio;
+} TraceEvent;
+
+typedef struct
+{
+    TraceTask tasks[TRACE_TABLE_SIZE];
+    int tasksCount;
+    long long evictionTimes[TRACE_MAX_TASKS];
+    TraceCpu cpus[TRACE_MAX_CPUS];
+    long long startingNs;
+    long long lastNs;
+    FILE* output;
+    TraceImportOptions options;
+    TraceImportSummary* summary;
+    SchedulerError error;
+} TraceImporter;
+
+
+bool ParseTraceEvent(const char* line, TraceEvent* oevent);
+bool ParseTraceTime(const char* text, long long* otimeNs);
+const char* FindTraceField(const char* fields, const char* key);
+bool GetTraceField(const char* fields, const char* key, const char* terminator, char* ovalue, size_t size);
+bool ParseCompactTask(const char* task, const char* taskEnd, char* ocomm, int* opid, int* oprio, const char** orest);
+bool CopyTraceValue(const char* value, size_t length, char* ovalue, size_t size);
+void HandleTraceEvent(TraceImporter* importer, const TraceEvent* event);
+int GetTaskSlot(int pid);
+TraceTask* FindTask(TraceImporter* importer, int pid);
+TraceTask* TrackTask(TraceImporter* importer, int pid, const char* name, int prio, long long timeNs);
+void EvictTasks(TraceImporter* importer);
+int CmpTraceTime(const void* a, const void* b);
+void FlushTask(TraceImporter* importer, TraceTask* task);
+void RemoveTask(TraceImporter* importer, int slot);
+
+
+
+TraceImportOptions DefaultTraceImportOptions()
+{
+    TraceImportOptions options;
+    options.timeUnitNs = TRACE_DEFAULT_TIME_UNIT_NS;
+    options.maxProcesses = MAX_PROC;
+
+    return options;
+}
+
+/*
+ * Writes the workload of 'trace' to 'output'. Lines which are not sched_switch, sched_wakeup(_new) or
+ * sched_process_exit events are counted as skipped, and a trace without any event fails with
+ * SCHEDULER_ERROR_NO_EVENTS.
+ */
+SchedulerError ImportTrace(FILE* trace, FILE* output, TraceImportOptions options, TraceImportSummary* osummary)
+{
+    if (trace == NULL || output == NULL || osummary == NULL || options.timeUnitNs <= 0 || options.maxProcesses < 0)
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+
+    TraceImporter* importer = calloc(1, sizeof(TraceImporter));
+    if (importer == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+    memset(osummary, 0, sizeof(TraceImportSummary));
+    importer->startingNs = -1;
+    importer->output = output;
+    importer->options = options;
+    importer->summary = osummary;
+
+
+
+    /*
+     * A single pass over the trace, only the current line is held in memory
+     */
+    char* line = NULL;
+    size_t line_length = 0;
+    TraceEvent event;
+    while (getline(&line, &line_length, trace) > 0)
+    {
+        osummary->linesCount++;
+        if (!ParseTraceEvent(line, &event))
+        {
+            osummary->skippedLinesCount++;
+            continue;
+        }
+
+        osummary->eventsCount++;
+        HandleTraceEvent(importer, &event);
+    }
+    SchedulerError error = ferror(trace) ? SCHEDULER_ERROR_SYSTEM : SCHEDULER_OK;
+    if (error == SCHEDULER_OK && osummary->eventsCount == 0)
+        error = SCHEDULER_ERROR_NO_EVENTS;
+    free(line);
+
+
+
+    /*
+     * Tasks still on a CPU ran until the end of the trace, then every task left is written
+     */
+    for (int cpu = 0; cpu < TRACE_MAX_CPUS; cpu++)
+    {
+        TraceTask* task = importer->cpus[cpu].pid != 0 ? FindTask(importer, importer->cpus[cpu].pid) : NULL;
+        if (task != NULL)
+        {
+            task->runNs += importer->lastNs - importer->cpus[cpu].sinceNs;
+            task->cpu = -1;
+        }
+    }
+    for (int slot = 0; slot < TRACE_TABLE_SIZE; slot++)
+        while (importer->tasks[slot].pid != 0)
+            FlushTask(importer, &importer->tasks[slot]);
+
+    if (error == SCHEDULER_OK)
+        error = importer->error;
+    if (error == SCHEDULER_OK && (fflush(output) != 0 || ferror(output)))
+        error = SCHEDULER_ERROR_SYSTEM;
+
+
+
+    free(importer);
+
+    return error;
+}
+
+/*
+ * Parses lines such as
+ *   bash-1234  [001] d..3  5021.123456: sched_switch: prev_comm=bash prev_pid=1234 ... ==> next_comm=...
+ *   bash  1234 [001]  5021.123456: sched:sched_wakeup: comm=sshd pid=812 prio=120 target_cpu=001
+ * and perf's compact form of the same events
+ *   bash  1234 [001]  5021.123456: sched:sched_switch: bash:1234 [120] S ==> swapper/1:0 [120]
+ *   bash  1234 [001]  5021.123456: sched:sched_wakeup: sshd:812 [120] CPU:001
+ * The timestamp is the token right before the event name and the CPU the last bracketed number before it.
+ */
+bool ParseTraceEvent(const char* line, TraceEvent* oevent)
+{
+    const char* names[] = { "sched_switch: ", "sched_wakeup: ", "sched_wakeup_new: ", "sched_process_exit: " };
+    const int kinds[] = { TRACE_EVENT_SWITCH, TRACE_EVENT_WAKEUP, TRACE_EVENT_WAKEUP, TRACE_EVENT_EXIT };
+    const char* eventStart = NULL;
+    int nameIdx;
+
+    for (nameIdx = 0; nameIdx < 4 && eventStart == NULL; nameIdx++)
+        eventStart = strstr(line, names[nameIdx]);
+    if (eventStart == NULL)
+        return false;
+    nameIdx--;
+
+    memset(oevent, 0, sizeof(TraceEvent));
+    oevent->kind = kinds[nameIdx];
+    const char* fields = eventStart + strlen(names[nameIdx]);
+
+
+
+    /*
+     * Walking back over "sched:" (perf only) and ": " to the timestamp
+     */
+    const char* timeEnd = eventStart;
+    if (timeEnd - line >= 6 && strncmp(timeEnd - 6, "sched:", 6) == 0)
+        timeEnd -= 6;
+    while (timeEnd > line && (timeEnd[-1] == ' ' || timeEnd[-1] == ':'))
+        timeEnd--;
+    const char* timeStart = timeEnd;
+    while (timeStart > line && timeStart[-1] != ' ')
+        timeStart--;
+    if (timeStart == timeEnd || !ParseTraceTime(timeStart, &oevent->timeNs))
+        return false;
+
+    const char* cpuStart = timeStart;
+    while (cpuStart > line && *cpuStart != '[')
+        cpuStart--;
+    if (*cpuStart != '[' || sscanf(cpuStart + 1, "%d", &oevent->cpu) != 1 || oevent->cpu < 0)
+        return false;
+
+
+
+    char number[16];
+    const char* arrow = strstr(fields, " ==> ");
+    if (oevent->kind == TRACE_EVENT_SWITCH && FindTraceField(fields, "prev_comm") == NULL)
+    {
+        const char* state;
+        if (arrow == NULL ||
+            !ParseCompactTask(fields, arrow, oevent->prevComm, &oevent->prevPid, &oevent->prevPrio, &state) ||
+            !ParseCompactTask(arrow + 5, arrow + 5 + strcspn(arrow + 5, "\n"), oevent->nextComm, &oevent->nextPid, &oevent->nextPrio, NULL))
+            return false;
+
+        size_t stateLength = strspn(state, " ");
+        if (!CopyTraceValue(state + stateLength, arrow - state - stateLength, oevent->prevState, sizeof(oevent->prevState)))
+            return false;
+    }
+    else if (oevent->kind != TRACE_EVENT_SWITCH && FindTraceField(fields, "comm") == NULL)
+    {
+        if (!ParseCompactTask(fields, fields + strcspn(fields, "\n"), oevent->nextComm, &oevent->nextPid, &oevent->nextPrio, NULL))
+            return false;
+    }
+    else if (oevent->kind == TRACE_EVENT_SWITCH)
+    {
+        if (!GetTraceField(fields, "prev_comm", " prev_pid=", oevent->prevComm, sizeof(oevent->prevComm)) ||
+            !GetTraceField(fields, "prev_pid", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->prevPid) != 1 ||
+            !GetTraceField(fields, "prev_prio", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->prevPrio) != 1 ||
+            !GetTraceField(fields, "prev_state", NULL, oevent->prevState, sizeof(oevent->prevState)) ||
+            !GetTraceField(fields, "next_comm", " next_pid=", oevent->nextComm, sizeof(oevent->nextComm)) ||
+            !GetTraceField(fields, "next_pid", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->nextPid) != 1 ||
+            !GetTraceField(fields, "next_prio", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->nextPrio) != 1)
+            return false;
+    }
+    else
+    {
+        if (!GetTraceField(fields, "comm", " pid=", oevent->nextComm, sizeof(oevent->nextComm)) ||
+            !GetTraceField(fields, "pid", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->nextPid) != 1 ||
+            !GetTraceField(fields, "prio", NULL, number, sizeof(number)) || sscanf(number, "%d", &oevent->nextPrio) != 1)
+            return false;
+    }
+
+    return oevent->prevPid >= 0 && oevent->nextPid >= 0;
+}
+
+/*
+ * Parses "<seconds>.<fraction>" into nanoseconds without going through a double
+ */
+bool ParseTraceTime(const char* text, long long* otimeNs)
+{
+    long long seconds = 0;
+    long long fractionNs = 0;
+    long long scale = 100000000LL;
+    const char* digit = text;
+
+    for (; *digit >= '0' && *digit <= '9'; digit++)
+        seconds = seconds * 10 + (*digit - '0');
+    if (digit == text || *digit != '.')
+        return false;
+    for (digit++; *digit >= '0' && *digit <= '9'; digit++, scale /= 10)
+        fractionNs += (*digit - '0') * scale;
+
+    *otimeNs = seconds * 1000000000LL + fractionNs;
+    return true;
+}
+
+/*
+ * Returns where the value of "key=" starts, the key having to start the fields or follow a space
+ */
+const char* FindTraceField(const char* fields, const char* key)
+{
+    size_t keyLength = strlen(key);
+
+    for (const char* match = strstr(fields, key); match != NULL; match = strstr(match + 1, key))
+        if ((match == fields || match[-1] == ' ') && match[keyLength] == '=')
+            return match + keyLength + 1;
+
+    return NULL;
+}
+
+/*
+ * Copies the value of 'key' up to 'terminator' (for names, which may contain spaces) or else up to the next
+ * space. Commas are replaced, so that the value can go into a CSV record.
+ */
+bool GetTraceField(const char* fields, const char* key, const char* terminator, char* ovalue, size_t size)
+{
+    const char* value = FindTraceField(fields, key);
+    if (value == NULL)
+        return false;
+
+    const char* valueEnd = terminator != NULL ? strstr(value, terminator) : NULL;
+    if (valueEnd == NULL)
+        valueEnd = value + strcspn(value, " \n");
+
+    return CopyTraceValue(value, valueEnd - value, ovalue, size);
+}
+
+/*
+ * Parses perf's "<comm>:<pid> [<prio>]" out of [task, taskEnd), the comm being everything before the last colon.
+ * *orest, when given, is set to what follows the prio.
+ */
+bool ParseCompactTask(const char* task, const char* taskEnd, char* ocomm, int* opid, int* oprio, const char** orest)
+{
+    const char* prioStart = taskEnd;
+    while (prioStart > task && *prioStart != '[')
+        prioStart--;
+    if (*prioStart != '[' || prioStart == task || prioStart[-1] != ' ')
+        return false;
+
+    const char* colon = prioStart - 1;
+    while (colon > task && *colon != ':')
+        colon--;
+    if (*colon != ':')
+        return false;
+
+    char* numberEnd;
+    long pid = strtol(colon + 1, &numberEnd, 10);
+    if (numberEnd == colon + 1 || numberEnd != prioStart - 1 || pid < 0 || pid > INT_MAX)
+        return false;
+    long prio = strtol(prioStart + 1, &numberEnd, 10);
+    if (numberEnd == prioStart + 1 || *numberEnd != ']' || prio < INT_MIN || prio > INT_MAX)
+        return false;
+
+    *opid = pid;
+    *oprio = prio;
+    if (orest != NULL)
+        *orest = numberEnd + 1;
+
+    return CopyTraceValue(task + strspn(task, " "), colon - task - strspn(task, " "), ocomm, MAX_NAME);
+}
+
+/*
+ * Commas are replaced, so that the value can go into a CSV record
+ */
+bool CopyTraceValue(const char* value, size_t length, char* ovalue, size_t size)
+{
+    if (length == 0 || length >= size)
+        return false;
+
+    for (size_t i = 0; i < length; i++)
+        ovalue[i] = value[i] == ',' || value[i] == '\r' ? '_' : value[i];
+    ovalue[length] = '\0';
+
+    return true;
+}
+
+void HandleTraceEvent(TraceImporter* importer, const TraceEvent* event)
+{
+    if (importer->startingNs == -1)
+        importer->startingNs = event->timeNs;
+    if (event->timeNs > importer->lastNs)
+        importer->lastNs = event->timeNs;
+
+
+
+    if (event->kind == TRACE_EVENT_WAKEUP)
+    {
+        if (event->nextPid != 0)
+            TrackTask(importer, event->nextPid, event->nextComm, event->nextPrio, event->timeNs);
+        return;
+    }
+
+    if (event->kind == TRACE_EVENT_EXIT)
+    {
+        TraceTask* task = FindTask(importer, event->nextPid);
+        if (task != NULL)
+        {
+            task->hasExited = true;
+            if (task->cpu == -1)
+                FlushTask(importer, task);
+        }
+        return;
+    }
+
+
+
+    /*
+     * A switch: the previous task leaves the CPU, accounting the time it had it, and the next one takes it
+     */
+    if (event->cpu >= TRACE_MAX_CPUS)
+        return;
+    TraceCpu* cpu = &importer->cpus[event->cpu];
+
+    if (event->prevPid != 0)
+    {
+        TraceTask* task = TrackTask(importer, event->prevPid, event->prevComm, event->prevPrio, event->timeNs);
+        if (task != NULL)
+        {
+            if (cpu->pid == event->prevPid)
+                task->runNs += event->timeNs - cpu->sinceNs;
+            task->cpu = -1;
+            if (task->hasExited || strpbrk(event->prevState, "XZ") != NULL)
+                FlushTask(importer, task);
+        }
+    }
+
+    cpu->pid = 0;
+    if (event->nextPid != 0)
+    {
+        TraceTask* task = TrackTask(importer, event->nextPid, event->nextComm, event->nextPrio, event->timeNs);
+        if (task != NULL)
+        {
+            task->cpu = event->cpu;
+            cpu->pid = event->nextPid;
+            cpu->sinceNs = event->timeNs;
+        }
+    }
+}
+
+int GetTaskSlot(int pid)
+{
+    return (int)(((unsigned int)pid * 2654435761u) & (TRACE_TABLE_SIZE - 1));
+}
+
+TraceTask* FindTask(TraceImporter* importer, int pid)
+{
+    for (int slot = GetTaskSlot(pid); importer->tasks[slot].pid != 0; slot = (slot + 1) & (TRACE_TABLE_SIZE - 1))
+        if (importer->tasks[slot].pid == pid)
+            return &importer->tasks[slot];
+
+    return NULL;
+}
+
+/*
+ * Returns the task of 'pid', starting to follow it if it is new. Returns NULL only if the table is full of
+ * tasks which are all on a CPU.
+ */
+TraceTask* TrackTask(TraceImporter* importer, int pid, const char* name, int prio, long long timeNs)
+{
+    TraceTask* task = FindTask(importer, pid);
+    if (task == NULL)
+    {
+        if (importer->tasksCount >= TRACE_MAX_TASKS)
+            EvictTasks(importer);
+        if (importer->tasksCount >= TRACE_MAX_TASKS)
+            return NULL;
+
+        int slot = GetTaskSlot(pid);
+        while (importer->tasks[slot].pid != 0)
+            slot = (slot + 1) & (TRACE_TABLE_SIZE - 1);
+
+        task = &importer->tasks[slot];
+        memset(task, 0, sizeof(TraceTask));
+        task->pid = pid;
+        strcpy(task->name, name);
+        task->firstSeenNs = timeNs;
+        task->cpu = -1;
+        importer->tasksCount++;
+    }
+
+    task->prio = prio;
+    task->lastActiveNs = timeNs;
+
+    return task;
+}
+
+/*
+ * Writes out up to TRACE_EVICTION_BATCH of the least recently active tasks which are off the CPU, to make room
+ * for new ones
+ */
+void EvictTasks(TraceImporter* importer)
+{
+    int candidatesCount = 0;
+    for (int slot = 0; slot < TRACE_TABLE_SIZE; slot++)
+        if (importer->tasks[slot].pid != 0 && importer->tasks[slot].cpu == -1)
+            importer->evictionTimes[candidatesCount++] = importer->tasks[slot].lastActiveNs;
+    if (candidatesCount == 0)
+        return;
+
+    qsort(importer->evictionTimes, candidatesCount, sizeof(long long), CmpTraceTime);
+    int batch = candidatesCount < TRACE_EVICTION_BATCH ? candidatesCount : TRACE_EVICTION_BATCH;
+    long long cutoffNs = importer->evictionTimes[batch - 1];
+
+
+
+    /*
+     * A removal shifts later entries back into the slot, which is why it is checked again
+     */
+    int evictedCount = 0;
+    for (int slot = 0; slot < TRACE_TABLE_SIZE && evictedCount < batch; slot++)
+        while (evictedCount < batch && importer->tasks[slot].pid != 0 && importer->tasks[slot].cpu == -1 &&
+               importer->tasks[slot].lastActiveNs <= cutoffNs)
+        {
+            FlushTask(importer, &importer->tasks[slot]);
+            evictedCount++;
+        }
+
+    importer->summary->evictionsCount += evictedCount;
+}
+
+int CmpTraceTime(const void* a, const void* b)
+{
+    long long timeA = *(const long long*)a;
+    long long timeB = *(const long long*)b;
+
+    return (timeA > timeB) - (timeA < timeB);
+}
+
+/*
+ * Writes the task's record, unless it never ran, and stops following it. A time which does not fit in the
+ * record's int fails the import, rather than being written wrapped around.
+ */
+void FlushTask(TraceImporter* importer, TraceTask* task)
+{
+    long long timeUnitNs = importer->options.timeUnitNs;
+
+    if (task->runNs > 0 && importer->summary->processesCount >= importer->options.maxProcesses)
+        importer->summary->droppedCount++;
+    else if (task->runNs > 0)
+    {
+        long long arrivalTime = (task->firstSeenNs - importer->startingNs) / timeUnitNs;
+        long long burstTime = (task->runNs + timeUnitNs / 2) / timeUnitNs;
+        if (arrivalTime > INT_MAX || burstTime > INT_MAX)
+        {
+            importer->error = SCHEDULER_ERROR_TIME_OVERFLOW;
+            RemoveTask(importer, task - importer->tasks);
+            return;
+        }
+        fprintf(importer->output, TRACE_RECORD, task->name, task->pid, arrivalTime, burstTime > 0 ? burstTime : 1,
+                task->prio - TRACE_NICE_0_PRIO);
+        importer->summary->processesCount++;
+    }
+
+    RemoveTask(importer, task - importer->tasks);
+}
+
+/*
+ * Linear probing removal: later entries of the same probe sequence are shifted back into the hole
+ */
+void RemoveTask(TraceImporter* importer, int slot)
+{
+    int mask = TRACE_TABLE_SIZE - 1;
+    int hole = slot;
+
+    for (int next = (slot + 1) & mask; importer->tasks[next].pid != 0; next = (next + 1) & mask)
+    {
+        int home = GetTaskSlot(importer->tasks[next].pid);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            importer->tasks[hole] = importer->tasks[next];
+            hole = next;
+        }
+    }
+
+    importer->tasks[hole].pid = 0;
+    importer->tasksCount--;
+}
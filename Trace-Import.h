@@ -0,0 +1,40 @@
+#ifndef TRACE_IMPORT_H
+#define TRACE_IMPORT_H
+
+#include <stdio.h>
+
+#include "CPU-Scheduler.h"
+
+/*
+ * Turns a Linux scheduler trace, the text output of ftrace or `perf script`/`perf sched script` with sched_switch
+ * and sched_wakeup events, in the key=value form or perf's compact one, into a workload in the ParseProcess() format: one record per task, arriving when the
+ * task was first seen, bursting for the CPU time it used and prioritised by its nice value (prio - 120).
+ *
+ * The trace is read in a single pass and memory stays bounded by the task table: a task's record is written
+ * as soon as it exits, and when the table is full the least recently active task which is not on a CPU is
+ * written early (its later activity then becomes a record of its own).
+ */
+#define TRACE_MAX_TASKS 4096
+#define TRACE_MAX_CPUS 1024
+
+typedef struct
+{
+    long timeUnitNs;
+    int maxProcesses;
+} TraceImportOptions;
+
+typedef struct
+{
+    long linesCount;
+    long eventsCount;
+    long skippedLinesCount;
+    int processesCount;
+    int evictionsCount;
+    int droppedCount;
+} TraceImportSummary;
+
+
+SCHEDULER_API TraceImportOptions DefaultTraceImportOptions();
+SCHEDULER_API SchedulerError ImportTrace(FILE* trace, FILE* output, TraceImportOptions options, TraceImportSummary* osummary);
+
+#endif
@@ -0,0 +1,316 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Workload-Pipeline.h"
+
+
+void* RunParser(void* context);
+void WakeRingSide(ProcessRing* ring, atomic_bool* isWaiting, pthread_cond_t* condition);
+bool PushRecord(WorkloadPipeline* pipeline, const Process* proc);
+SchedulerError PopRecord(WorkloadPipeline* pipeline, Process* oproc, bool* oisEnd);
+bool IsReleasedBefore(const Process* a, const Process* b);
+void PushWindow(WorkloadPipeline* pipeline, Process proc);
+Process PopWindow(WorkloadPipeline* pipeline);
+
+
+
+/*
+ * malloc() only aligns to max_align_t, less than the ring's cache lines. The size of an aligned type is a multiple
+ * of its alignment, as aligned_alloc() requires. The pipeline is released with free().
+ */
+WorkloadPipeline* WorkloadPipelineAlloc()
+{
+    return aligned_alloc(_Alignof(WorkloadPipeline), sizeof(WorkloadPipeline));
+}
+
+/*
+ * Opens the workload right away, so that a missing file fails here rather than in the middle of a run
+ */
+SchedulerError WorkloadPipelineStart(WorkloadPipeline* pipeline, const char* path, int window, Process oprocs[])
+{
+    memset(pipeline, 0, sizeof(WorkloadPipeline));
+    pthread_mutex_init(&pipeline->ring.lock, NULL);
+    pthread_cond_init(&pipeline->ring.hasRoom, NULL);
+    pthread_cond_init(&pipeline->ring.hasRecords, NULL);
+    if (window <= 0 || window > PIPELINE_MAX_WINDOW)
+        return SCHEDULER_ERROR_INVALID_ARGUMENT;
+
+    pipeline->procs = oprocs;
+    pipeline->window = window;
+    atomic_init(&pipeline->ring.head, 0);
+    atomic_init(&pipeline->ring.tail, 0);
+    atomic_init(&pipeline->ring.isProducerWaiting, false);
+    atomic_init(&pipeline->ring.isConsumerWaiting, false);
+    atomic_init(&pipeline->isParsed, false);
+    atomic_init(&pipeline->isCancelled, false);
+
+    if ((pipeline->file = fopen(path, "r")) == NULL)
+        return SCHEDULER_ERROR_SYSTEM;
+
+    int result = pthread_create(&pipeline->parser, NULL, RunParser, pipeline);
+    if (result != 0)
+    {
+        errno = result;
+        return SCHEDULER_ERROR_SYSTEM;
+    }
+    pipeline->isParserStarted = true;
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * Releases the next record in arrival order, blocking until the window is full again or the parser is done.
+ * *oproc points into the workload and is NULL once every record was released.
+ */
+SchedulerError WorkloadPipelineNext(WorkloadPipeline* pipeline, const Process** oproc)
+{
+    *oproc = NULL;
+    if (pipeline->isDrained)
+        return SCHEDULER_OK;
+
+    while (pipeline->windowSize <= pipeline->window)
+    {
+        Process proc;
+        bool isEnd = false;
+        SchedulerError error = PopRecord(pipeline, &proc, &isEnd);
+        if (error != SCHEDULER_OK)
+            return error;
+        if (isEnd)
+            break;
+
+        /*
+         * Records were released once more were received than the window holds
+         */
+        if (pipeline->procsCount > pipeline->windowSize && proc.arrival_time < pipeline->watermark)
+            return SCHEDULER_ERROR_OUT_OF_ORDER;
+        pipeline->procs[proc.original_idx] = proc;
+        pipeline->procsCount++;
+        PushWindow(pipeline, proc);
+    }
+
+    if (pipeline->windowSize == 0)
+    {
+        pipeline->isDrained = true;
+        return SCHEDULER_OK;
+    }
+
+    Process earliest = PopWindow(pipeline);
+    pipeline->watermark = earliest.arrival_time;
+    *oproc = &pipeline->procs[earliest.original_idx];
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * Stops the parser if it is still running. Safe after a failed WorkloadPipelineStart(), and keeps errno so that
+ * the error which ended the run can still be reported.
+ */
+void WorkloadPipelineEnd(WorkloadPipeline* pipeline, int* oprocsCount)
+{
+    int savedErrno = errno;
+
+    /*
+     * Taking the lock makes sure the parser either sees the cancellation before it sleeps or is woken from it
+     */
+    pthread_mutex_lock(&pipeline->ring.lock);
+    atomic_store_explicit(&pipeline->isCancelled, true, memory_order_relaxed);
+    pthread_cond_signal(&pipeline->ring.hasRoom);
+    pthread_mutex_unlock(&pipeline->ring.lock);
+    if (pipeline->isParserStarted)
+        pthread_join(pipeline->parser, NULL);
+    pipeline->isParserStarted = false;
+    if (pipeline->file != NULL)
+        fclose(pipeline->file);
+    pipeline->file = NULL;
+    pthread_cond_destroy(&pipeline->ring.hasRecords);
+    pthread_cond_destroy(&pipeline->ring.hasRoom);
+    pthread_mutex_destroy(&pipeline->ring.lock);
+
+    if (oprocsCount != NULL)
+        *oprocsCount = pipeline->procsCount;
+    errno = savedErrno;
+}
+
+
+
+/*
+ * The producer: parses the workload the way InitProcessesFromCSV() does, pushing every record as soon as it is
+ * parsed
+ */
+void* RunParser(void* context)
+{
+    WorkloadPipeline* pipeline = context;
+    struct timespec startingTime;
+    struct timespec endingTime;
+    SchedulerError error = SCHEDULER_OK;
+    char* line = NULL;
+    size_t line_length = 0;
+    int procsCount = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &startingTime);
+    while (error == SCHEDULER_OK && getline(&line, &line_length, pipeline->file) > 0)
+    {
+        if (procsCount >= MAX_PROC)
+        {
+            error = SCHEDULER_ERROR_TOO_MANY_PROCESSES;
+            break;
+        }
+
+        Process proc;
+        if ((error = ParseProcess(line, &proc)) != SCHEDULER_OK)
+            break;
+        proc.original_idx = procsCount++;
+        if (!PushRecord(pipeline, &proc))
+            break;
+    }
+
+    if (error == SCHEDULER_OK && ferror(pipeline->file))
+        error = SCHEDULER_ERROR_SYSTEM;
+    pipeline->parseErrno = errno;
+    free(line);
+
+    clock_gettime(CLOCK_MONOTONIC, &endingTime);
+    pipeline->parseTime = (double)(endingTime.tv_sec - startingTime.tv_sec) + (double)(endingTime.tv_nsec - startingTime.tv_nsec) / 1e9;
+    pipeline->parseError = error;
+    pthread_mutex_lock(&pipeline->ring.lock);
+    atomic_store_explicit(&pipeline->isParsed, true, memory_order_release);
+    pthread_cond_signal(&pipeline->ring.hasRecords);
+    pthread_mutex_unlock(&pipeline->ring.lock);
+
+    return NULL;
+}
+
+/*
+ * Sleeps while the ring is full, returns false if the consumer gave up in the meantime
+ */
+bool PushRecord(WorkloadPipeline* pipeline, const Process* proc)
+{
+    ProcessRing* ring = &pipeline->ring;
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == PIPELINE_RING_SIZE)
+    {
+        pthread_mutex_lock(&ring->lock);
+        atomic_store(&ring->isProducerWaiting, true);
+        while (tail - atomic_load(&ring->head) == PIPELINE_RING_SIZE &&
+               !atomic_load_explicit(&pipeline->isCancelled, memory_order_relaxed))
+            pthread_cond_wait(&ring->hasRoom, &ring->lock);
+        atomic_store(&ring->isProducerWaiting, false);
+        pthread_mutex_unlock(&ring->lock);
+
+        if (atomic_load_explicit(&pipeline->isCancelled, memory_order_relaxed))
+            return false;
+    }
+
+    ring->slots[tail & (PIPELINE_RING_SIZE - 1)] = *proc;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    WakeRingSide(ring, &ring->isConsumerWaiting, &ring->hasRecords);
+
+    return true;
+}
+
+/*
+ * Waits for the next record while the ring is empty. *oisEnd is set once the parser is done and every record it
+ * pushed was popped, which is also when its error, if any, is reported.
+ */
+SchedulerError PopRecord(WorkloadPipeline* pipeline, Process* oproc, bool* oisEnd)
+{
+    ProcessRing* ring = &pipeline->ring;
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+    {
+        pthread_mutex_lock(&ring->lock);
+        atomic_store(&ring->isConsumerWaiting, true);
+        while (head == atomic_load(&ring->tail) && !atomic_load_explicit(&pipeline->isParsed, memory_order_acquire))
+            pthread_cond_wait(&ring->hasRecords, &ring->lock);
+        atomic_store(&ring->isConsumerWaiting, false);
+        pthread_mutex_unlock(&ring->lock);
+
+        /*
+         * Records pushed before isParsed was set are visible once it is, so the ring is checked again
+         */
+        if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+        {
+            *oisEnd = true;
+            errno = pipeline->parseErrno;
+            return pipeline->parseError;
+        }
+    }
+
+    *oproc = ring->slots[head & (PIPELINE_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    WakeRingSide(ring, &ring->isProducerWaiting, &ring->hasRoom);
+
+    return SCHEDULER_OK;
+}
+
+/*
+ * Called after publishing a slot. The fence pairs with the sleeping side raising its flag before checking the
+ * ring again: either that check sees the slot, or the flag is seen here and the lock makes the signal arrive
+ * once the side is asleep.
+ */
+void WakeRingSide(ProcessRing* ring, atomic_bool* isWaiting, pthread_cond_t* condition)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load_explicit(isWaiting, memory_order_relaxed))
+        return;
+
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_signal(condition);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/*
+ * The window's order: by arrival, then by position in the CSV
+ */
+bool IsReleasedBefore(const Process* a, const Process* b)
+{
+    if (a->arrival_time != b->arrival_time)
+        return a->arrival_time < b->arrival_time;
+
+    return a->original_idx < b->original_idx;
+}
+
+void PushWindow(WorkloadPipeline* pipeline, Process proc)
+{
+    Process* heap = pipeline->windowHeap;
+    int i = pipeline->windowSize++;
+
+    while (i > 0 && IsReleasedBefore(&proc, &heap[(i - 1) / 2]))
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = proc;
+}
+
+/*
+ * The window must not be empty
+ */
+Process PopWindow(WorkloadPipeline* pipeline)
+{
+    Process* heap = pipeline->windowHeap;
+    Process earliest = heap[0];
+    Process last = heap[--pipeline->windowSize];
+    int size = pipeline->windowSize;
+    int i = 0;
+
+    while (2 * i + 1 < size)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < size && IsReleasedBefore(&heap[child + 1], &heap[child]))
+            child++;
+        if (!IsReleasedBefore(&heap[child], &last))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+
+    return earliest;
+}
@@ -0,0 +1,81 @@
+#ifndef WORKLOAD_PIPELINE_H
+#define WORKLOAD_PIPELINE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "CPU-Scheduler.h"
+
+/*
+ * Pipelined workload loading: a parser thread reads the CSV and hands every record to the simulation thread over
+ * a single producer, single consumer ring, so that simulating starts as soon as the first arrivals are parsed
+ * instead of once the whole file is loaded.
+ *
+ * Records are released in arrival order (CSV order between equal arrivals) through a reorder window, a min-heap
+ * holding the last 'window' records received. A record which arrives before one that was already released is out
+ * of order beyond the window and fails the run with SCHEDULER_ERROR_OUT_OF_ORDER.
+ */
+#define PIPELINE_RING_SIZE 256
+#define PIPELINE_MAX_WINDOW MAX_PROC
+
+#if (PIPELINE_RING_SIZE & (PIPELINE_RING_SIZE - 1)) != 0
+#error "PIPELINE_RING_SIZE must be a power of two"
+#endif
+
+/*
+ * head is only written by the consumer and tail only by the producer, each on its own cache line. Both count
+ * records forever and wrap around the slots.
+ *
+ * A side finding the ring full (the producer) or empty (the consumer) raises its waiting flag and sleeps on its
+ * condition under 'lock'. The other side only takes the lock to wake it when that flag is raised, so that passing
+ * a record through a ring which is neither stays lock free.
+ */
+typedef struct
+{
+    _Alignas(64) atomic_uint head;
+    _Alignas(64) atomic_uint tail;
+    _Alignas(64) Process slots[PIPELINE_RING_SIZE];
+    _Alignas(64) pthread_mutex_t lock;
+    pthread_cond_t hasRoom;
+    pthread_cond_t hasRecords;
+    atomic_bool isProducerWaiting;
+    atomic_bool isConsumerWaiting;
+} ProcessRing;
+
+/*
+ * Everything above 'procs' is shared with the parser thread, parseError, parseErrno and parseTime being written
+ * before isParsed is set. 'watermark' is the arrival time of the last record released, no record released later
+ * arrives before it.
+ *
+ * The ring's cache line alignment only holds if the pipeline is allocated with WorkloadPipelineAlloc().
+ */
+typedef struct
+{
+    FILE* file;
+    pthread_t parser;
+    bool isParserStarted;
+    ProcessRing ring;
+    atomic_bool isParsed;
+    atomic_bool isCancelled;
+    SchedulerError parseError;
+    int parseErrno;
+    double parseTime;
+
+    Process* procs;
+    int procsCount;
+    int window;
+    int windowSize;
+    Process windowHeap[PIPELINE_MAX_WINDOW + 1];
+    int watermark;
+    bool isDrained;
+} WorkloadPipeline;
+
+
+WorkloadPipeline* WorkloadPipelineAlloc();
+SchedulerError WorkloadPipelineStart(WorkloadPipeline* pipeline, const char* path, int window, Process oprocs[]);
+SchedulerError WorkloadPipelineNext(WorkloadPipeline* pipeline, const Process** oproc);
+void WorkloadPipelineEnd(WorkloadPipeline* pipeline, int* oprocsCount);
+
+#endif
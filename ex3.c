@@ -2,13 +2,49 @@
 #include <string.h>
 #include <stdlib.h>
 
-#include "Focus-Mode.c"
-#include "CPU-Scheduler.c"
+#include "CPU-Scheduler.h"
+#include "Focus-Mode.h"
+#include "Scheduler-Daemon.h"
+#include "Trace-Import.h"
 
 #define REQUIRED_ARGS              2
 #define FOCUS_MODE_CMD             "Focus-Mode"
+#define FOCUS_LOAD_CMD             "Focus-Load"
 #define CPU_SCHEDULER_CMD          "CPU-Scheduler"
-#define USAGE                      "Usage: %s <Focus-Mode/CPU-Schedule> <Num-Of-Rounds/Processes.csv> <Round-Duration/Time-Quantum>"
+#define IMPORT_TRACE_CMD           "Import-Trace"
+#define DAEMON_CMD                 "Scheduler-Daemon"
+#define STDIN_PATH                 "-"
+#define STATS_OPTION               "--stats"
+#define TIME_SCALE_OPTION          "--time-scale="
+#define CHECKPOINT_OPTION          "--checkpoint="
+#define CHECKPOINT_EVERY_OPTION    "--checkpoint-every="
+#define RESUME_OPTION              "--resume="
+#define EXECUTOR_OPTION            "--executor"
+#define EXECUTOR_CPU_OPTION        "--executor-cpu="
+#define SWITCH_COST_OPTION         "--switch-cost="
+#define CACHE_REFILL_OPTION        "--cache-refill="
+#define CACHE_COLD_OPTION          "--cache-cold-after="
+#define PIPELINE_OPTION            "--pipeline"
+#define PIPELINE_WINDOW_OPTION     "--pipeline="
+#define TIME_UNIT_OPTION           "--time-unit="
+#define SCRIPT_OPTION              "--script="
+#define TIMED_OPTION               "--timed"
+#define CATALOG_OPTION             "--catalog="
+#define COUNTS_OPTION              "--counts"
+#define RATE_OPTION                "--rate="
+#define WORKERS_OPTION             "--workers="
+#define IMPORT_SUMMARY             "Imported %d processes from %ld events (%ld of %ld lines skipped, %d tasks written early, %d dropped)\n"
+#define USAGE                      "Usage: %s <Focus-Mode/Focus-Load/CPU-Schedule/Import-Trace/Scheduler-Daemon> <Num-Of-Rounds/Processes.csv> <Round-Duration/Time-Quantum> " \
+                                   "[" STATS_OPTION "] [" TIME_SCALE_OPTION "<1s/1ms/10us/0>] " \
+                                   "[" CHECKPOINT_OPTION "<file>] [" CHECKPOINT_EVERY_OPTION "<units>] [" RESUME_OPTION "<file>] " \
+                                   "[" EXECUTOR_OPTION "] [" EXECUTOR_CPU_OPTION "<cpu>] " \
+                                   "[" SWITCH_COST_OPTION "<units>] [" CACHE_REFILL_OPTION "<units>] [" CACHE_COLD_OPTION "<units>] " \
+                                   "[" PIPELINE_OPTION "[=<window>]] [" SCRIPT_OPTION "<distractions.txt>] [" TIMED_OPTION "] " \
+                                   "[" CATALOG_OPTION "<catalog.txt>] [" COUNTS_OPTION "]\n"
+#define USAGE_IMPORT_TRACE         "Usage: %s " IMPORT_TRACE_CMD " <trace.txt/" STDIN_PATH "> [" TIME_UNIT_OPTION "<1ms>]\n"
+#define USAGE_DAEMON               "Usage: %s " DAEMON_CMD " <socket-path> [" WORKERS_OPTION "<count>]\n"
+#define USAGE_FOCUS_LOAD           "Usage: %s " FOCUS_LOAD_CMD " <Generators> <Seconds> [" RATE_OPTION "<signals/s>] " \
+                                   "[" CATALOG_OPTION "<catalog.txt>] [" COUNTS_OPTION "]\n"
 
 int main(const int argc, const char* const * argv)
 {
@@ -22,16 +58,202 @@ int main(const int argc, const char* const * argv)
     {
         int numOfRounds = atoi(argv[2]);
         int duration = atoi(argv[3]);
+        FocusOptions options = DefaultFocusOptions();
 
-        HandleFocusMode(numOfRounds, duration);
+        for (int i = 4; i < argc; i++)
+        {
+            if (strncmp(argv[i], SCRIPT_OPTION, strlen(SCRIPT_OPTION)) == 0)
+                options.scriptPath = argv[i] + strlen(SCRIPT_OPTION);
+            else if (strcmp(argv[i], TIMED_OPTION) == 0)
+                options.isTimed = true;
+            else if (strncmp(argv[i], CATALOG_OPTION, strlen(CATALOG_OPTION)) == 0)
+                options.catalogPath = argv[i] + strlen(CATALOG_OPTION);
+            else if (strcmp(argv[i], COUNTS_OPTION) == 0)
+                options.shouldShowCounts = true;
+            else
+            {
+                printf(USAGE, argv[0]);
+                exit(1);
+            }
+        }
+
+        /*
+         * A script is replayed as fast as possible, so its rounds cannot be timed
+         */
+        if (options.scriptPath != NULL && options.isTimed)
+        {
+            printf(USAGE, argv[0]);
+            exit(1);
+        }
+
+        HandleFocusMode(numOfRounds, duration, options);
+        exit(0);
+    }
+    else if (strcmp(argv[1], FOCUS_LOAD_CMD) == 0)
+    {
+        FocusOptions options = DefaultFocusOptions();
+        if (argc < 4)
+        {
+            printf(USAGE_FOCUS_LOAD, argv[0]);
+            exit(1);
+        }
+        for (int i = 4; i < argc; i++)
+        {
+            if (strncmp(argv[i], RATE_OPTION, strlen(RATE_OPTION)) == 0)
+                options.loadRate = atoi(argv[i] + strlen(RATE_OPTION));
+            else if (strncmp(argv[i], CATALOG_OPTION, strlen(CATALOG_OPTION)) == 0)
+                options.catalogPath = argv[i] + strlen(CATALOG_OPTION);
+            else if (strcmp(argv[i], COUNTS_OPTION) == 0)
+                options.shouldShowCounts = true;
+            else
+                options.loadRate = 0;
+
+            if (options.loadRate <= 0)
+            {
+                printf(USAGE_FOCUS_LOAD, argv[0]);
+                exit(1);
+            }
+        }
+
+        HandleFocusLoad(atoi(argv[2]), atoi(argv[3]), options);
         exit(0);
     }
     else if (strcmp(argv[1], CPU_SCHEDULER_CMD) == 0)
     {
         const char* processesCsvFilePath = argv[2];
         int timeQuantum = atoi(argv[3]);
+        SchedulerOptions options = DefaultSchedulerOptions();
+
+        for (int i = 4; i < argc; i++)
+        {
+            if (strcmp(argv[i], STATS_OPTION) == 0)
+                options.shouldCollectStats = true;
+            else if (strncmp(argv[i], TIME_SCALE_OPTION, strlen(TIME_SCALE_OPTION)) == 0)
+                options.timeUnitNs = ParseTimeUnit(argv[i] + strlen(TIME_SCALE_OPTION));
+            else if (strncmp(argv[i], CHECKPOINT_OPTION, strlen(CHECKPOINT_OPTION)) == 0)
+                options.checkpointPath = argv[i] + strlen(CHECKPOINT_OPTION);
+            else if (strncmp(argv[i], CHECKPOINT_EVERY_OPTION, strlen(CHECKPOINT_EVERY_OPTION)) == 0)
+                options.checkpointInterval = atoi(argv[i] + strlen(CHECKPOINT_EVERY_OPTION));
+            else if (strncmp(argv[i], RESUME_OPTION, strlen(RESUME_OPTION)) == 0)
+                options.resumePath = argv[i] + strlen(RESUME_OPTION);
+            else if (strcmp(argv[i], EXECUTOR_OPTION) == 0)
+                options.shouldExecute = true;
+            else if (strncmp(argv[i], EXECUTOR_CPU_OPTION, strlen(EXECUTOR_CPU_OPTION)) == 0)
+                options.executorCpu = atoi(argv[i] + strlen(EXECUTOR_CPU_OPTION));
+            else if (strncmp(argv[i], SWITCH_COST_OPTION, strlen(SWITCH_COST_OPTION)) == 0)
+                options.costModel.switchCost = atoi(argv[i] + strlen(SWITCH_COST_OPTION));
+            else if (strncmp(argv[i], CACHE_REFILL_OPTION, strlen(CACHE_REFILL_OPTION)) == 0)
+                options.costModel.cacheRefillCost = atoi(argv[i] + strlen(CACHE_REFILL_OPTION));
+            else if (strncmp(argv[i], CACHE_COLD_OPTION, strlen(CACHE_COLD_OPTION)) == 0)
+                options.costModel.cacheColdTime = atoi(argv[i] + strlen(CACHE_COLD_OPTION));
+            else if (strcmp(argv[i], PIPELINE_OPTION) == 0)
+                options.pipelineWindow = PIPELINE_DEFAULT_WINDOW;
+            else if (strncmp(argv[i], PIPELINE_WINDOW_OPTION, strlen(PIPELINE_WINDOW_OPTION)) == 0)
+                options.pipelineWindow = atoi(argv[i] + strlen(PIPELINE_WINDOW_OPTION));
+            else
+                options.timeUnitNs = -1;
+
+            if (options.timeUnitNs == -1 || options.checkpointInterval <= 0 || options.pipelineWindow < 0)
+            {
+                printf(USAGE, argv[0]);
+                exit(1);
+            }
+        }
+
+        SchedulerError error = HandleCPUScheduler(processesCsvFilePath, timeQuantum, options);
+        if (error == SCHEDULER_ERROR_SYSTEM)
+        {
+            perror("CPU-Scheduler error");
+            exit(EXIT_FAILURE);
+        }
+        if (error != SCHEDULER_OK)
+        {
+            fprintf(stderr, "CPU-Scheduler error: %s\n", SchedulerErrorString(error));
+            exit(EXIT_FAILURE);
+        }
+        exit(0);
+    }
+    else if (strcmp(argv[1], IMPORT_TRACE_CMD) == 0)
+    {
+        TraceImportOptions options = DefaultTraceImportOptions();
+        if (argc < 3)
+        {
+            printf(USAGE_IMPORT_TRACE, argv[0]);
+            exit(1);
+        }
+        for (int i = 3; i < argc; i++)
+        {
+            if (strncmp(argv[i], TIME_UNIT_OPTION, strlen(TIME_UNIT_OPTION)) == 0)
+                options.timeUnitNs = ParseTimeUnit(argv[i] + strlen(TIME_UNIT_OPTION));
+            else
+                options.timeUnitNs = -1;
+
+            if (options.timeUnitNs <= 0)
+            {
+                printf(USAGE_IMPORT_TRACE, argv[0]);
+                exit(1);
+            }
+        }
+
+        FILE* trace = stdin;
+        if (strcmp(argv[2], STDIN_PATH) != 0 && (trace = fopen(argv[2], "r")) == NULL)
+        {
+            perror("fopen() error");
+            exit(EXIT_FAILURE);
+        }
+
+        TraceImportSummary summary;
+        SchedulerError error = ImportTrace(trace, stdout, options, &summary);
+        if (trace != stdin)
+            fclose(trace);
+        if (error == SCHEDULER_ERROR_SYSTEM)
+        {
+            perror("Import-Trace error");
+            exit(EXIT_FAILURE);
+        }
+        if (error != SCHEDULER_OK)
+        {
+            fprintf(stderr, "Import-Trace error: %s\n", SchedulerErrorString(error));
+            exit(EXIT_FAILURE);
+        }
+
+        fprintf(stderr, IMPORT_SUMMARY, summary.processesCount, summary.eventsCount, summary.skippedLinesCount,
+                summary.linesCount, summary.evictionsCount, summary.droppedCount);
+        exit(0);
+    }
+    else if (strcmp(argv[1], DAEMON_CMD) == 0)
+    {
+        int workersCount = DAEMON_DEFAULT_WORKERS;
+        if (argc < 3)
+        {
+            printf(USAGE_DAEMON, argv[0]);
+            exit(1);
+        }
+        for (int i = 3; i < argc; i++)
+        {
+            if (strncmp(argv[i], WORKERS_OPTION, strlen(WORKERS_OPTION)) == 0)
+                workersCount = atoi(argv[i] + strlen(WORKERS_OPTION));
+            else
+                workersCount = -1;
+
+            if (workersCount <= 0 || workersCount > DAEMON_MAX_WORKERS)
+            {
+                printf(USAGE_DAEMON, argv[0]);
+                exit(1);
+            }
+        }
 
-        HandleCPUScheduler(processesCsvFilePath, timeQuantum);
+        SchedulerError error = HandleSchedulerDaemon(argv[2], workersCount);
+        if (error == SCHEDULER_ERROR_SYSTEM)
+        {
+            perror("Scheduler-Daemon error");
+            exit(EXIT_FAILURE);
+        }
+        if (error != SCHEDULER_OK)
+        {
+            fprintf(stderr, "Scheduler-Daemon error: %s\n", SchedulerErrorString(error));
+            exit(EXIT_FAILURE);
+        }
         exit(0);
     }
     else